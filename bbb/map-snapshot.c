@@ -0,0 +1,192 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+// Save and inspect the arena snapshots the zed prints on its console.
+//
+//   map-snapshot save <file> < console.log
+//     Save the last complete snapshot in the console capture to file.
+//   map-snapshot show <file>
+//     Map the file and draw its obstacles.
+//   map-snapshot send <file> > /dev/ttyACM0
+//     Print the file as the zed prints snapshots, for the zed to load while
+//     it waits for one at power on.
+//
+// On the console, a snapshot is a "snapshot begin <bytes>" line, lines of
+// "snapshot <hex>", and a "snapshot end" line.
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "search_snapshot_file.h"
+
+// Return the value of a hex digit, or -1.
+static int hex_value(char c)
+{
+    if ((c >= '0') && (c <= '9')) {
+        return c - '0';
+    }
+    if ((c >= 'a') && (c <= 'f')) {
+        return c - 'a' + 10;
+    }
+    if ((c >= 'A') && (c <= 'F')) {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// Decode the last complete snapshot on stdin, and save it.
+// Return zero on success, non-zero on failure.
+static int snapshot_save(const char *name)
+{
+    size_t n = 0;
+    char *line = 0;
+
+    // The snapshot being decoded, and the last complete one.
+    unsigned char *buffer = 0;
+    size_t size = 0, used = 0;
+    unsigned char *complete = 0;
+    size_t complete_size = 0;
+
+    int bytes;
+    while (getline(&line, &n, stdin) != -1) {
+        if (sscanf(line, "snapshot begin %d", &bytes) == 1) {
+            free(buffer);
+
+            // malloc leaves the buffer aligned for search_snapshot_view.
+            buffer = (bytes > 0) ? (unsigned char*)malloc(bytes) : 0;
+            size = buffer ? bytes : 0;
+            used = 0;
+            continue;
+        }
+        if (!strncmp(line, "snapshot end", strlen("snapshot end"))) {
+            if (buffer && (used == size)) {
+                free(complete);
+                complete = buffer;
+                complete_size = size;
+            } else {
+                free(buffer);
+                fprintf(stderr, "ignoring truncated snapshot\n");
+            }
+            buffer = 0;
+            size = used = 0;
+            continue;
+        }
+        if (!buffer || strncmp(line, "snapshot ", strlen("snapshot "))) {
+            continue;
+        }
+        const char *p = line + strlen("snapshot ");
+        for (;;) {
+            const int hi = hex_value(p[0]);
+            const int lo = (hi < 0) ? -1 : hex_value(p[1]);
+            if (lo < 0) {
+                break;
+            }
+            if (used == size) {
+                fprintf(stderr, "snapshot overrun\n");
+                free(buffer);
+                buffer = 0;
+                break;
+            }
+            buffer[used++] = (unsigned char)((hi << 4) | lo);
+            p += 2;
+        }
+    }
+    free(line);
+    free(buffer);
+
+    if (!complete) {
+        fprintf(stderr, "no snapshot found\n");
+        return 1;
+    }
+    search_bits_t bits;
+    unsigned runs;
+    int status = search_snapshot_view(complete, complete_size, &bits, &runs);
+    if (status) {
+        fprintf(stderr, "invalid snapshot\n");
+    } else {
+        status = search_snapshot_save(name, &bits, runs);
+        if (!status) {
+            printf("saved %dx%d runs %u to %s\n", bits.dim_x, bits.dim_y,
+                    runs, name);
+        }
+    }
+    free(complete);
+    return status;
+}
+
+// Draw the snapshot's obstacles, y up, as the oled shows them.
+// Return zero on success, non-zero on failure.
+static int snapshot_show(const char *name)
+{
+    search_snapshot_file_t file;
+    int status = search_snapshot_open(&file, name);
+    if (status) {
+        return status;
+    }
+    printf("%dx%d runs %u\n", file.bits.dim_x, file.bits.dim_y, file.runs);
+    int x, y;
+    for (y = file.bits.dim_y-1; y >= 0; --y) {
+        for (x = 0; x < file.bits.dim_x; ++x) {
+            putchar(search_bits_test(&file.bits, x, y) ? '#' : '.');
+        }
+        putchar('\n');
+    }
+    search_snapshot_close(&file);
+    return 0;
+}
+
+// Print the snapshot file the way the zed prints snapshots.
+// Return zero on success, non-zero on failure.
+static int snapshot_send(const char *name)
+{
+    search_snapshot_file_t file;
+    int status = search_snapshot_open(&file, name);
+    if (status) {
+        return status;
+    }
+    const size_t size = search_snapshot_bytes(file.bits.dim_x,
+            file.bits.dim_y);
+    unsigned char *buffer = (unsigned char*)malloc(size);
+    if (!buffer) {
+        fprintf(stderr, "malloc failed\n");
+        search_snapshot_close(&file);
+        return 1;
+    }
+    status = search_snapshot_write(&file.bits, file.runs, buffer, size);
+    search_snapshot_close(&file);
+    if (status) {
+        free(buffer);
+        return status;
+    }
+    printf("snapshot begin %d\n", (int)size);
+    size_t i;
+    for (i = 0; i < size; ++i) {
+        if (!(i%32)) {
+            printf("snapshot ");
+        }
+        printf("%02x", buffer[i]);
+        if (((i%32) == 31) || ((i+1) == size)) {
+            printf("\n");
+        }
+    }
+    printf("snapshot end\n");
+    free(buffer);
+    return 0;
+}
+
+// Application entry point.
+int main(int argc, char **argv)
+{
+    if (argc == 3) {
+        if (!strcmp(argv[1], "save")) {
+            return snapshot_save(argv[2]);
+        }
+        if (!strcmp(argv[1], "show")) {
+            return snapshot_show(argv[2]);
+        }
+        if (!strcmp(argv[1], "send")) {
+            return snapshot_send(argv[2]);
+        }
+    }
+    fprintf(stderr, "usage: %s save|show|send <file>\n", argv[0]);
+    return 1;
+}
@@ -0,0 +1 @@
+../hw3/hw3.sdk/SDK/SDK_Export/irobot_test_0/src/search.h
\ No newline at end of file
@@ -0,0 +1,211 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#include <iostream>
+#include <cstdlib>
+#include <pthread.h>
+#include <unistd.h>
+
+extern "C" {
+#include "search_batch.h"
+}
+
+// A run of queries still to answer, [head, tail). The owner takes from the
+// head, thieves take from the tail.
+struct batch_run {
+    pthread_mutex_t lock;
+    int head, tail;
+};
+
+struct batch {
+    search_map_t *map;
+    search_query_t *queries;
+    search_path_t *paths;
+    search_mode_t mode;
+    int threads;
+    batch_run *runs;
+};
+
+struct batch_worker {
+    batch *b;
+    int id;
+    search_context_t context;
+
+    // where paths go when the caller doesn't want them.
+    search_path_t path;
+    pthread_t thread;
+};
+
+// Take the next query from a run.
+// Returns the query, or -1 if the run is empty.
+static int run_take(batch_run *run)
+{
+    pthread_mutex_lock(&run->lock);
+    const int i = (run->head < run->tail) ? run->head++ : -1;
+    pthread_mutex_unlock(&run->lock);
+    return i;
+}
+
+// Refill the worker's run with half of the longest other run.
+// Returns zero on success, non-zero once every run is empty.
+static int run_steal(batch *b, int id)
+{
+    for (;;) {
+        int victim = -1;
+        int longest = 0;
+        for (int i = 0; i < b->threads; ++i) {
+            batch_run *run = &b->runs[i];
+            pthread_mutex_lock(&run->lock);
+            const int length = run->tail - run->head;
+            pthread_mutex_unlock(&run->lock);
+            if ((i != id) && (length > longest)) {
+                victim = i;
+                longest = length;
+            }
+        }
+        if (victim < 0) {
+            return 1;
+        }
+
+        // The victim may have moved on since it was measured; if it's been
+        // emptied, look again.
+        batch_run *run = &b->runs[victim];
+        pthread_mutex_lock(&run->lock);
+        const int length = run->tail - run->head;
+        const int tail = run->tail;
+        const int taken = (length+1)/2;
+        run->tail -= taken;
+        pthread_mutex_unlock(&run->lock);
+        if (taken <= 0) {
+            continue;
+        }
+        batch_run *own = &b->runs[id];
+        pthread_mutex_lock(&own->lock);
+        own->head = tail - taken;
+        own->tail = tail;
+        pthread_mutex_unlock(&own->lock);
+        return 0;
+    }
+}
+
+// Answer one query with the worker's context.
+static void answer(batch_worker *w, int i)
+{
+    batch *b = w->b;
+    search_map_t *map = b->map;
+    search_query_t *q = &b->queries[i];
+    search_path_t *path = b->paths ? &b->paths[i] : &w->path;
+    q->length = -1;
+    if ((q->start_x < 0) || (q->start_x >= map->dim_x) ||
+            (q->start_y < 0) || (q->start_y >= map->dim_y) ||
+            (q->goal_x < 0) || (q->goal_x >= map->dim_x) ||
+            (q->goal_y < 0) || (q->goal_y >= map->dim_y)) {
+        return;
+    }
+    const search_cell_t *start = search_cell_at(map, q->start_x, q->start_y);
+    const search_cell_t *goal = search_cell_at(map, q->goal_x, q->goal_y);
+    if (!search_context_find(&w->context, start, goal, b->mode, path)) {
+        q->length = path->length;
+    }
+}
+
+static void* worker_thread(void *context)
+{
+    batch_worker *w = (batch_worker*)context;
+    batch_run *own = &w->b->runs[w->id];
+    for (;;) {
+        int i = run_take(own);
+        if (i < 0) {
+            if (run_steal(w->b, w->id)) {
+                break;
+            }
+            continue;
+        }
+        answer(w, i);
+    }
+    return 0;
+}
+
+int search_find_batch(search_map_t *map, search_query_t *queries, int count,
+        search_path_t *paths, search_mode_t mode, int threads)
+{
+    if (!threads) {
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads > count) {
+        threads = count;
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    batch b;
+    b.map = map;
+    b.queries = queries;
+    b.paths = paths;
+    b.mode = mode;
+    b.threads = threads;
+    b.runs = (batch_run*)malloc(sizeof(batch_run)*threads);
+    batch_worker *workers = (batch_worker*)malloc(sizeof(batch_worker)*threads);
+    if (!b.runs || !workers) {
+        std::cout << "malloc failed" << std::endl;
+        free(b.runs);
+        free(workers);
+        return 1;
+    }
+
+    // Deal the queries out in equal runs, and set up each worker before any
+    // thread starts, so a failure leaves nothing running.
+    int status = 0;
+    int ready = 0;
+    for (; ready < threads; ++ready) {
+        batch_run *run = &b.runs[ready];
+        pthread_mutex_init(&run->lock, 0);
+        run->head = (int)(((long)count*ready)/threads);
+        run->tail = (int)(((long)count*(ready+1))/threads);
+
+        batch_worker *w = &workers[ready];
+        w->b = &b;
+        w->id = ready;
+        if (search_context_alloc(&w->context, map)) {
+            status = 1;
+            break;
+        }
+        if (search_path_alloc(&w->path, map->dim_x*map->dim_y)) {
+            search_context_free(&w->context);
+            status = 1;
+            break;
+        }
+    }
+
+    // Start the pool. The calling thread waits rather than working, so every
+    // worker is a thread of its own.
+    int started = 0;
+    for (; !status && (started < threads); ++started) {
+        if (pthread_create(&workers[started].thread, 0, worker_thread,
+                    &workers[started])) {
+            std::cout << "pthread_create failed" << std::endl;
+            status = 1;
+
+            // Leave the unstarted runs to the started workers.
+            break;
+        }
+    }
+    if (status && started) {
+        status = 0;
+    }
+    for (int i = 0; i < started; ++i) {
+        pthread_join(workers[i].thread, 0);
+    }
+
+    for (int i = 0; i < ready; ++i) {
+        search_path_free(&workers[i].path);
+        search_context_free(&workers[i].context);
+        pthread_mutex_destroy(&b.runs[i].lock);
+    }
+    if (ready < threads) {
+        pthread_mutex_destroy(&b.runs[ready].lock);
+    }
+    free(workers);
+    free(b.runs);
+    return status;
+}
@@ -0,0 +1,30 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_batch_h_
+#define _search_batch_h_
+
+#include "search_context.h"
+
+// One start and goal pair, and its answer.
+typedef struct {
+    // the cells to search between.
+    int start_x, start_y;
+    int goal_x, goal_y;
+
+    // the number of moves on the path, or -1 if the goal can't be reached or
+    // the path didn't fit.
+    int length;
+} search_query_t;
+
+// Answer every query on the map, spread across a pool of threads. Each thread
+// searches with a context of its own; the map is shared and must not change
+// until the batch returns. Queries are dealt out in equal runs, one per
+// thread, and a thread that finishes its run steals half of what's left of
+// the longest other run, so a few slow queries don't hold up the batch.
+//
+// threads of 0 uses one thread per online processor. If paths isn't null,
+// it holds one path per query and each query's path is written to it.
+// Returns zero on success, non-zero if the pool couldn't be set up.
+int search_find_batch(search_map_t *map, search_query_t *queries, int count,
+        search_path_t *paths, search_mode_t mode, int threads);
+#endif
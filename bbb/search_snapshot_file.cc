@@ -0,0 +1,107 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+extern "C" {
+#include "search_snapshot_file.h"
+}
+
+int search_snapshot_open(search_snapshot_file_t *file, const char *name)
+{
+    file->base = 0;
+    file->size = 0;
+    const int fd = open(name, O_RDONLY);
+    if (fd == -1) {
+        fprintf(stderr, "open failed %d\n", errno);
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        fprintf(stderr, "fstat failed %d\n", errno);
+        close(fd);
+        return 1;
+    }
+    if (!st.st_size) {
+        fprintf(stderr, "empty snapshot %s\n", name);
+        close(fd);
+        return 1;
+    }
+
+    // The mapping holds its own reference to the file.
+    void *base = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "mmap failed %d\n", errno);
+        return 1;
+    }
+    if (search_snapshot_view(base, st.st_size, &file->bits, &file->runs)) {
+        fprintf(stderr, "invalid snapshot %s\n", name);
+        munmap(base, st.st_size);
+        return 1;
+    }
+    file->base = base;
+    file->size = st.st_size;
+    return 0;
+}
+
+void search_snapshot_close(search_snapshot_file_t *file)
+{
+    if (file->base) {
+        munmap(file->base, file->size);
+    }
+    file->base = 0;
+    file->size = 0;
+    file->bits.rows = 0;
+}
+
+int search_snapshot_save(const char *name, const search_bits_t *bits,
+        unsigned runs)
+{
+    const size_t size = search_snapshot_bytes(bits->dim_x, bits->dim_y);
+    void *buffer = malloc(size);
+    if (!buffer) {
+        fprintf(stderr, "malloc failed\n");
+        return 1;
+    }
+    search_snapshot_write(bits, runs, buffer, size);
+
+    const size_t length = strlen(name);
+    char *temp = (char*)malloc(length + 5);
+    if (!temp) {
+        fprintf(stderr, "malloc failed\n");
+        free(buffer);
+        return 1;
+    }
+    memcpy(temp, name, length);
+    memcpy(temp + length, ".tmp", 5);
+
+    int status = 1;
+    FILE *f = fopen(temp, "wb");
+    if (!f) {
+        fprintf(stderr, "fopen failed %d\n", errno);
+    } else {
+        const int written = (fwrite(buffer, 1, size, f) == size);
+        if ((fclose(f) == 0) && written) {
+            if (rename(temp, name) == -1) {
+                fprintf(stderr, "rename failed %d\n", errno);
+            } else {
+                status = 0;
+            }
+        } else {
+            fprintf(stderr, "write failed %d\n", errno);
+        }
+        if (status) {
+            unlink(temp);
+        }
+    }
+    free(temp);
+    free(buffer);
+    return status;
+}
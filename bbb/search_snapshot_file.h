@@ -0,0 +1,35 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_snapshot_file_h_
+#define _search_snapshot_file_h_
+
+#include "search_snapshot.h"
+
+// A snapshot file mapped into memory. The bitboard points straight into the
+// mapping, so opening a snapshot reads only the pages that are used, and
+// processes opening the same file share them.
+typedef struct {
+    // the mapping, read-only.
+    void *base;
+    size_t size;
+
+    // the snapshot's obstacles, and the runs that found them.
+    search_bits_t bits;
+    unsigned runs;
+} search_snapshot_file_t;
+
+// Map the named snapshot file. The bitboard is read-only; copy it before
+// changing it.
+// Returns zero on success, non-zero if the file can't be mapped or isn't a
+// valid snapshot.
+int search_snapshot_open(search_snapshot_file_t *file, const char *name);
+
+// Unmap the file. The bitboard is no longer valid.
+void search_snapshot_close(search_snapshot_file_t *file);
+
+// Save a snapshot of the bitboard to the named file. The snapshot is written
+// alongside and renamed into place, so readers never see a partial one.
+// Returns zero on success, non-zero on failure.
+int search_snapshot_save(const char *name, const search_bits_t *bits,
+        unsigned runs);
+#endif
@@ -0,0 +1,562 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+// Host benchmark for search_find. The open list backend is chosen when
+// search.cc is compiled, so the makefile builds one binary per backend. Each
+// binary also runs jump point search, a std::set open list for reference,
+// the packed map layout, the distance field, the hierarchical planner, the
+// anytime planner and bidirectional A* over the same queries, reports how
+// batches of queries scale across threads, times configuration space
+// updates, and counts the drive segments smoothing saves.
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <time.h>
+
+extern "C" {
+#include "search.h"
+#include "search_packed.h"
+#include "search_field.h"
+#include "search_hpa.h"
+#include "search_ara.h"
+#include "search_batch.h"
+#include "search_bidir.h"
+#include "search_cspace.h"
+#include "search_path.h"
+#include "search_smooth.h"
+}
+
+#ifdef SEARCH_OPEN_BUCKET
+static const char *backend = "bucket";
+#else
+static const char *backend = "heap";
+#endif
+
+// The benchmark arenas, and the percentage of cells that are blocked. The
+// first is the arena used on the robot. The open and cluttered arenas show
+// where jump point search does and doesn't pay off.
+struct arena {
+    int dim_x, dim_y;
+    int obstacle_percent;
+    int queries;
+};
+static const arena arenas[] = {
+    { 16, 8, 20, 10000 },
+    { 256, 256, 20, 200 },
+    { 4096, 4096, 20, 4 },
+    { 256, 256, 0, 200 },
+    { 1024, 1024, 5, 20 },
+    { 256, 256, 35, 200 },
+};
+
+static double now_us()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (t.tv_sec * 1e6) + (t.tv_nsec / 1e3);
+}
+
+// The std::set open list search_find used to have. Ties are broken on the
+// cell address so equal f cells aren't dropped, and improved cells are
+// erased and reinserted.
+struct order_cell {
+    bool operator()(const search_cell_t *lhs, const search_cell_t *rhs) const {
+        if (lhs->f != rhs->f) {
+            return lhs->f < rhs->f;
+        }
+        if (lhs->h != rhs->h) {
+            return lhs->h < rhs->h;
+        }
+        return lhs < rhs;
+    }
+};
+
+// search_map_initialize only bumps the map generation, so cells are reset on
+// first touch the same way search_find does it.
+static void set_touch(search_map_t *map, search_cell_t *c)
+{
+    if (c->generation != map->generation) {
+        c->prev = c->next = 0;
+        c->open = c->closed = 0;
+        c->generation = map->generation;
+    }
+}
+
+static void set_find(search_map_t *map, search_cell_t *start, search_cell_t *goal)
+{
+    typedef std::set<search_cell_t*,order_cell> open_t;
+    open_t open;
+    set_touch(map, start);
+    set_touch(map, goal);
+    start->g = 0;
+    start->h = std::abs(start->x-goal->x) + std::abs(start->y-goal->y);
+    start->f = start->h;
+    start->open = true;
+    open.insert(start);
+
+    while (!open.empty() && !goal->closed) {
+        search_cell_t *current = *open.begin();
+        open.erase(open.begin());
+        current->open = false;
+        current->closed = true;
+
+        static const int p[][2] = {{-1,0},{1,0},{0,-1},{0,1}};
+        for (unsigned i = 0; i < sizeof(p)/sizeof(*p); ++i) {
+            const int x = current->x + p[i][0];
+            const int y = current->y + p[i][1];
+            if ((x < 0) || (y < 0) || (x >= map->dim_x) || (y >= map->dim_y)) {
+                continue;
+            }
+            search_cell_t *adj = search_cell_at(map,x,y);
+            set_touch(map, adj);
+            if (adj->blocked || adj->closed) {
+                continue;
+            }
+            if (adj->open) {
+                if ((current->g+1) >= adj->g) {
+                    continue;
+                }
+                open.erase(adj);
+            }
+            adj->prev = current;
+            adj->g = current->g + 1;
+            adj->h = std::abs(adj->x-goal->x) + std::abs(adj->y-goal->y);
+            adj->f = adj->g + adj->h;
+            adj->open = true;
+            open.insert(adj);
+        }
+    }
+}
+
+static void jps_find(search_map_t *map, search_cell_t *start, search_cell_t *goal)
+{
+    search_find_mode(map, start, goal, search_mode_jps);
+}
+
+// The number of cells expanded by the last search.
+static long expanded(const search_map_t *map)
+{
+    long count = 0;
+    for (int i = 0; i < map->dim_x*map->dim_y; ++i) {
+        const search_cell_t *c = &map->cells[i];
+        count += (c->generation == map->generation) && c->closed;
+    }
+    return count;
+}
+
+// Run the queries through the given search, reporting time per query, cells
+// expanded, and the total path length so the searches can be checked
+// against each other.
+typedef void (*find_t)(search_map_t*, search_cell_t*, search_cell_t*);
+static void run(search_map_t *map, const int *queries, int count,
+        const char *name, find_t find)
+{
+    double elapsed_us = 0;
+    long path_total = 0;
+    long expanded_total = 0;
+    for (int i = 0; i < count; ++i) {
+        const int *q = &queries[4*i];
+        search_map_initialize(map,0);
+        search_cell_t *start = search_cell_at(map,q[0],q[1]);
+        search_cell_t *goal = search_cell_at(map,q[2],q[3]);
+
+        const double t = now_us();
+        find(map, start, goal);
+        elapsed_us += now_us() - t;
+
+        if (goal->closed) {
+            path_total += goal->g;
+        }
+        expanded_total += expanded(map);
+    }
+    printf("map %dx%d backend %s queries %d us/query %.2f expanded/query %ld "
+            "path_total %ld\n", map->dim_x, map->dim_y, name, count,
+            elapsed_us/count, expanded_total/count, path_total);
+}
+
+// Run the queries through the packed map layout.
+static void run_packed(search_map_t *map, const int *queries, int count)
+{
+    search_packed_t packed;
+    if (search_packed_alloc(&packed, map->dim_x, map->dim_y)) {
+        return;
+    }
+    for (int i = 0; i < map->dim_x*map->dim_y; ++i) {
+        search_packed_set_blocked(&packed, map->cells[i].x, map->cells[i].y,
+                map->cells[i].blocked);
+    }
+
+    double elapsed_us = 0;
+    long path_total = 0;
+    for (int i = 0; i < count; ++i) {
+        const int *q = &queries[4*i];
+        search_packed_initialize(&packed,0);
+
+        const double t = now_us();
+        const int length = search_packed_find(&packed, q[0], q[1], q[2], q[3]);
+        elapsed_us += now_us() - t;
+
+        if (length >= 0) {
+            path_total += length;
+        }
+    }
+    printf("map %dx%d backend packed queries %d us/query %.2f path_total %ld\n",
+            map->dim_x, map->dim_y, count, elapsed_us/count, path_total);
+    printf("map %dx%d bytes cells %lu packed %lu\n", map->dim_x, map->dim_y,
+            (unsigned long)sizeof(search_cell_t)*map->dim_x*map->dim_y,
+            (unsigned long)search_packed_bytes(map->dim_x, map->dim_y));
+    search_packed_free(&packed);
+}
+
+// Run the queries through a distance field from each start. A single field
+// answers every goal from its start, so this is the worst case for it.
+static void run_field(search_map_t *map, const int *queries, int count)
+{
+    search_field_t field;
+    if (search_field_alloc(&field, map->dim_x, map->dim_y)) {
+        return;
+    }
+    double elapsed_us = 0;
+    long path_total = 0;
+    for (int i = 0; i < count; ++i) {
+        const int *q = &queries[4*i];
+        search_cell_t *goal = search_cell_at(map,q[2],q[3]);
+
+        const double t = now_us();
+        search_distance_field(&field, map, q[0], q[1]);
+        const int status = search_field_path(&field, map, goal);
+        elapsed_us += now_us() - t;
+
+        if (!status) {
+            path_total += search_field_distance(&field, q[2], q[3]);
+        }
+    }
+    printf("map %dx%d backend field queries %d us/query %.2f path_total %ld\n",
+            map->dim_x, map->dim_y, count, elapsed_us/count, path_total);
+    search_field_free(&field);
+}
+
+// Run the queries through the hierarchical planner, then again after
+// toggling one cell before each query, which is the replanning case.
+static void run_hpa(search_map_t *map, const int *queries, int count)
+{
+    search_hpa_t hpa;
+    if (search_hpa_alloc(&hpa, map, 16)) {
+        return;
+    }
+    double t = now_us();
+    search_hpa_update(&hpa);
+    const double build_us = now_us() - t;
+
+    double elapsed_us = 0;
+    double replan_us = 0;
+    long path_total = 0;
+    for (int i = 0; i < count; ++i) {
+        const int *q = &queries[4*i];
+        search_cell_t *start = search_cell_at(map,q[0],q[1]);
+        search_cell_t *goal = search_cell_at(map,q[2],q[3]);
+
+        t = now_us();
+        const int status = search_hpa_find(&hpa, start, goal);
+        elapsed_us += now_us() - t;
+        if (!status) {
+            for (search_cell_t *c = start; c != goal; c = c->next) {
+                ++path_total;
+            }
+        }
+
+        // Toggle a cell away from the query and replan.
+        search_cell_t *c = &map->cells[rand()%(map->dim_x*map->dim_y)];
+        if ((c == start) || (c == goal)) {
+            continue;
+        }
+        search_map_set_blocked(map, c, !c->blocked);
+        t = now_us();
+        search_hpa_find(&hpa, start, goal);
+        replan_us += now_us() - t;
+        search_map_set_blocked(map, c, !c->blocked);
+    }
+    printf("map %dx%d backend hpa queries %d us/query %.2f build_us %.2f "
+            "replan_us/query %.2f path_total %ld\n", map->dim_x, map->dim_y,
+            count, elapsed_us/count, build_us, replan_us/count, path_total);
+    search_hpa_free(&hpa);
+}
+
+// Run the queries through the anytime planner with a few expansion budgets,
+// reporting how many queries had a path within the budget and how long
+// those paths were.
+static void run_ara(search_map_t *map, const int *queries, int count)
+{
+    search_ara_t ara;
+    if (search_ara_alloc(&ara, map)) {
+        return;
+    }
+    static const int budgets[] = { 256, 1024, 0 };
+    for (unsigned b = 0; b < sizeof(budgets)/sizeof(*budgets); ++b) {
+        double elapsed_us = 0;
+        long path_total = 0;
+        int found = 0;
+        for (int i = 0; i < count; ++i) {
+            const int *q = &queries[4*i];
+            search_cell_t *start = search_cell_at(map,q[0],q[1]);
+            search_cell_t *goal = search_cell_at(map,q[2],q[3]);
+
+            const double t = now_us();
+            search_ara_initialize(&ara, start, goal, 30, 5);
+            const int status = search_ara_find(&ara, budgets[b], 0, 0);
+            elapsed_us += now_us() - t;
+            if (!status) {
+                ++found;
+                for (search_cell_t *c = start; c != goal; c = c->next) {
+                    ++path_total;
+                }
+            }
+        }
+        printf("map %dx%d backend ara budget %d queries %d us/query %.2f "
+                "found %d path_total %ld\n", map->dim_x, map->dim_y,
+                budgets[b], count, elapsed_us/count, found, path_total);
+    }
+    search_ara_free(&ara);
+}
+
+// Run the queries through bidirectional A* and search_find side by side,
+// then again on long routes, from the left eighth of the map to the right
+// eighth, where searching from both ends pays off most.
+static void run_bidir(search_map_t *map, const int *queries, int count)
+{
+    search_bidir_t bidir;
+    if (search_bidir_alloc(&bidir, map)) {
+        return;
+    }
+    int *long_queries = new int[4*count];
+    const int band = (map->dim_x+7)/8;
+    for (int i = 0; i < count; ++i) {
+        int *q = &long_queries[4*i];
+        do {
+            q[0] = rand()%band;
+            q[1] = rand()%map->dim_y;
+        } while (search_cell_at(map,q[0],q[1])->blocked);
+        do {
+            q[2] = map->dim_x - 1 - (rand()%band);
+            q[3] = rand()%map->dim_y;
+        } while (search_cell_at(map,q[2],q[3])->blocked);
+    }
+
+    for (int pass = 0; pass < 2; ++pass) {
+        const int *set = pass ? long_queries : queries;
+        double astar_us = 0, bidir_us = 0;
+        long astar_expanded = 0, bidir_expanded = 0;
+        long astar_total = 0, bidir_total = 0;
+        for (int i = 0; i < count; ++i) {
+            const int *q = &set[4*i];
+            search_cell_t *start = search_cell_at(map,q[0],q[1]);
+            search_cell_t *goal = search_cell_at(map,q[2],q[3]);
+
+            search_map_initialize(map,0);
+            double t = now_us();
+            search_find(map, start, goal);
+            astar_us += now_us() - t;
+            astar_expanded += expanded(map);
+            if (goal->closed) {
+                astar_total += goal->g;
+            }
+
+            t = now_us();
+            const int status = search_bidir_find(&bidir, start, goal);
+            bidir_us += now_us() - t;
+            bidir_expanded += bidir.expanded;
+            if (!status) {
+                for (search_cell_t *c = start; c != goal; c = c->next) {
+                    ++bidir_total;
+                }
+            }
+        }
+        printf("map %dx%d backend bidir routes %s queries %d us/query %.2f "
+                "expanded/query %ld path_total %ld astar us/query %.2f "
+                "expanded/query %ld path_total %ld\n", map->dim_x, map->dim_y,
+                pass ? "long" : "random", count, bidir_us/count,
+                bidir_expanded/count, bidir_total, astar_us/count,
+                astar_expanded/count, astar_total);
+    }
+    delete [] long_queries;
+    search_bidir_free(&bidir);
+}
+
+// Run the queries as batches across growing thread pools, repeating them so
+// each batch has a few thousand queries to share out. Every thread has a
+// whole map of scratch cells, so the biggest maps are left out.
+static void run_batch(search_map_t *map, const int *queries, int count)
+{
+    if ((map->dim_x*map->dim_y) > (256*256)) {
+        return;
+    }
+    const int repeat = (2000 + count - 1)/count;
+    const int total = count*repeat;
+    search_query_t *batch = new search_query_t[total];
+    static const int threads[] = { 1, 2, 4, 8 };
+    for (unsigned t = 0; t < sizeof(threads)/sizeof(*threads); ++t) {
+        for (int i = 0; i < total; ++i) {
+            const int *q = &queries[4*(i%count)];
+            batch[i].start_x = q[0];
+            batch[i].start_y = q[1];
+            batch[i].goal_x = q[2];
+            batch[i].goal_y = q[3];
+        }
+
+        const double t0 = now_us();
+        if (search_find_batch(map, batch, total, 0, search_mode_astar,
+                    threads[t])) {
+            break;
+        }
+        const double elapsed_us = now_us() - t0;
+
+        long path_total = 0;
+        for (int i = 0; i < count; ++i) {
+            if (batch[i].length >= 0) {
+                path_total += batch[i].length;
+            }
+        }
+        printf("map %dx%d backend batch threads %d queries %d queries/s %.0f "
+                "path_total %ld\n", map->dim_x, map->dim_y, threads[t], total,
+                (total*1e6)/elapsed_us, path_total);
+    }
+    delete [] batch;
+}
+
+// Inflate the map's obstacles into a configuration space on a map of its
+// own, then time adding and removing single obstacles against building the
+// whole layer again. The layer keeps several arrays per cell, so the biggest
+// maps are left out.
+static void run_cspace(search_map_t *map)
+{
+    if ((map->dim_x*map->dim_y) > (1024*1024)) {
+        return;
+    }
+    search_map_t inflated;
+    if (search_map_alloc(&inflated, map->dim_x, map->dim_y)) {
+        return;
+    }
+    search_map_initialize(&inflated,1);
+    search_cspace_t cspace;
+    if (search_cspace_alloc(&cspace, &inflated, 1)) {
+        search_map_free(&inflated);
+        return;
+    }
+
+    double t = now_us();
+    for (int y = 0; y < map->dim_y; ++y) {
+        for (int x = 0; x < map->dim_x; ++x) {
+            if (search_cell_at(map,x,y)->blocked) {
+                search_cspace_set(&cspace, x, y, 1);
+            }
+        }
+    }
+    const double build_us = now_us() - t;
+
+    const int updates = 1000;
+    long changed = 0;
+    t = now_us();
+    for (int i = 0; i < updates; ++i) {
+        const int x = rand()%map->dim_x;
+        const int y = rand()%map->dim_y;
+        changed += search_cspace_set(&cspace, x, y, 1);
+        changed += search_cspace_set(&cspace, x, y,
+                search_cell_at(map,x,y)->blocked);
+    }
+    const double update_us = now_us() - t;
+    printf("map %dx%d backend cspace radius 1 build us %.0f updates %d "
+            "us/update %.2f changed/update %.2f\n", map->dim_x, map->dim_y,
+            build_us, 2*updates, update_us/(2*updates),
+            (double)changed/(2*updates));
+
+    search_cspace_free(&cspace);
+    search_map_free(&inflated);
+}
+
+// Count the drive segments each route takes: one per cell, one per straight
+// run, and one per any-angle segment once the path is pulled taut.
+static void run_smooth(search_map_t *map, const int *queries, int count)
+{
+    search_path_t path;
+    if (search_path_alloc(&path, map->dim_x*map->dim_y)) {
+        return;
+    }
+    int *waypoints = new int[2*(map->dim_x*map->dim_y + 1)];
+    long cells = 0, runs = 0, segments = 0;
+    double elapsed_us = 0;
+    int found = 0;
+    for (int i = 0; i < count; ++i) {
+        const int *q = &queries[4*i];
+        search_cell_t *start = search_cell_at(map,q[0],q[1]);
+        search_cell_t *goal = search_cell_at(map,q[2],q[3]);
+        search_map_initialize(map,0);
+        if (search_find_path(map, start, goal, search_mode_astar, &path)) {
+            continue;
+        }
+        ++found;
+        cells += path.length;
+
+        const double t = now_us();
+        for (int m = 0; m < path.length; m += search_path_run(&path, m, 0)) {
+            ++runs;
+        }
+        const int n = search_path_smooth(&map->bits, &path, waypoints,
+                map->dim_x*map->dim_y + 1);
+        elapsed_us += now_us() - t;
+        if (n > 1) {
+            segments += n - 1;
+        }
+    }
+    printf("map %dx%d backend smooth queries %d found %d us/query %.2f "
+            "cells %ld runs %ld segments %ld\n", map->dim_x, map->dim_y,
+            count, found, found ? elapsed_us/found : 0, cells, runs, segments);
+    delete [] waypoints;
+    search_path_free(&path);
+}
+
+int main(int argc, char **argv)
+{
+    // search_find reports each query on stdout; keep the results readable.
+    std::cout.setstate(std::ios::failbit);
+    srand(237);
+
+    for (unsigned a = 0; a < sizeof(arenas)/sizeof(*arenas); ++a) {
+        search_map_t map;
+        if (search_map_alloc(&map, arenas[a].dim_x, arenas[a].dim_y)) {
+            return 1;
+        }
+        search_map_initialize(&map,1);
+        for (int i = 0; i < map.dim_x*map.dim_y; ++i) {
+            search_map_set_blocked(&map, &map.cells[i],
+                    (rand()%100) < arenas[a].obstacle_percent);
+        }
+        printf("map %dx%d obstacles %d%%\n", map.dim_x, map.dim_y,
+                arenas[a].obstacle_percent);
+
+        // Pick unblocked start and goal pairs.
+        const int count = arenas[a].queries;
+        int *queries = new int[4*count];
+        for (int i = 0; i < 4*count; i += 2) {
+            do {
+                queries[i] = rand()%map.dim_x;
+                queries[i+1] = rand()%map.dim_y;
+            } while (search_cell_at(&map,queries[i],queries[i+1])->blocked);
+        }
+
+        run(&map, queries, count, backend, search_find);
+        run(&map, queries, count, "jps", jps_find);
+        run(&map, queries, count, "set", set_find);
+        run_packed(&map, queries, count);
+        run_field(&map, queries, count);
+        run_hpa(&map, queries, count);
+        run_ara(&map, queries, count);
+        run_bidir(&map, queries, count);
+        run_batch(&map, queries, count);
+        run_cspace(&map);
+        run_smooth(&map, queries, count);
+
+        delete [] queries;
+        search_map_free(&map);
+    }
+    return 0;
+}
@@ -0,0 +1,638 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+// Host benchmark over a corpus of maps, where search_bench makes up its own.
+// Each argument is one of:
+//   a Moving AI scenario (.scen), whose queries run on the maps it names,
+//   found next to the scenario;
+//   a Moving AI map (.map), or an arena snapshot (.smap) saved by bbb's
+//   map-snapshot, each run with random queries between open cells.
+//
+// Moving AI maps are 8-connected, but the planners here move in 4, so each
+// query is checked against a breadth-first search rather than the scenario's
+// octile length. Every planner runs the same queries, and each path is walked
+// to check it's unblocked and ends at the goal.
+//
+// D* Lite, which replans every irobot_move, also drives part way along each
+// of its paths and flips cells near the robot between blocked and open,
+// replanning after each change. Its row counts every plan as a query, each
+// checked against a breadth-first search of the map as it is then. The
+// flipped cells are restored after each query.
+//
+// The output is one line per map and planner, of space separated key value
+// pairs:
+//   map <file> dim <x>x<y> planner <name> optimal <0|1> queries <n>
+//   found <n> ns/query <n> expanded/query <n> length_total <n>
+//   reference_total <n> missed <n> invalid <n> suboptimal <n>
+// expanded/query is -1 for planners that don't count expansions. missed
+// counts queries where the planner and the reference disagree on whether the
+// goal can be reached, and invalid counts broken paths. These, and longer
+// paths from a planner that should find the shortest, are regressions. The
+// last line totals them, and the exit status is non-zero if there are any.
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <time.h>
+
+extern "C" {
+#include "search.h"
+#include "search_bidir.h"
+#include "search_dstar.h"
+#include "search_field.h"
+#include "search_hpa.h"
+#include "search_path.h"
+#include "search_snapshot_file.h"
+}
+
+// The random queries run on a map without a scenario.
+static const int random_queries = 1000;
+
+// The cell changes D* replans around in each query, the steps it drives
+// along its path before each, and how far from the robot changed cells lie.
+static const int dstar_updates = 8;
+static const int dstar_steps = 2;
+static const int dstar_reach = 4;
+
+// Everything the planners need for one map.
+struct corpus {
+    search_map_t map;
+    search_path_t path;
+    search_stats_t stats;
+    search_field_t field;
+    search_bidir_t bidir;
+    search_hpa_t hpa;
+    search_dstar_t dstar;
+
+    // the breadth-first reference: distances from the start, -1 if
+    // unreached, and the queue of cells to visit.
+    std::vector<int> distance;
+    std::vector<int> queue;
+};
+
+static long long now_ns()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (t.tv_sec * 1000000000LL) + t.tv_nsec;
+}
+
+// A planner. find returns zero if it found the goal, with the path in
+// corpus->path, or threaded through the cells' next fields if threaded is
+// set, and sets expanded to the cells it expanded, or -1 if it can't tell.
+typedef int (*corpus_find_t)(corpus *c, search_cell_t *start,
+        search_cell_t *goal, int *expanded);
+struct planner {
+    const char *name;
+    int optimal;
+    int threaded;
+    corpus_find_t find;
+};
+
+static int astar_find(corpus *c, search_cell_t *start, search_cell_t *goal,
+        int *expanded)
+{
+    search_map_initialize(&c->map, 0);
+    const int status = search_find_path(&c->map, start, goal,
+            search_mode_astar, &c->path);
+    *expanded = c->stats.last.expanded;
+    return status;
+}
+
+static int jps_find(corpus *c, search_cell_t *start, search_cell_t *goal,
+        int *expanded)
+{
+    search_map_initialize(&c->map, 0);
+    const int status = search_find_path(&c->map, start, goal,
+            search_mode_jps, &c->path);
+    *expanded = c->stats.last.expanded;
+    return status;
+}
+
+static int bidir_find(corpus *c, search_cell_t *start, search_cell_t *goal,
+        int *expanded)
+{
+    const int status = search_bidir_find(&c->bidir, start, goal);
+    *expanded = c->bidir.expanded;
+    return status;
+}
+
+static int field_find(corpus *c, search_cell_t *start, search_cell_t *goal,
+        int *expanded)
+{
+    search_distance_field(&c->field, &c->map, start->x, start->y);
+    *expanded = -1;
+    return search_field_path(&c->field, &c->map, goal);
+}
+
+static int hpa_find(corpus *c, search_cell_t *start, search_cell_t *goal,
+        int *expanded)
+{
+    *expanded = -1;
+    return search_hpa_find(&c->hpa, start, goal);
+}
+
+static const planner planners[] = {
+    { "astar", 1, 0, astar_find },
+    { "jps", 1, 0, jps_find },
+    { "bidir", 1, 1, bidir_find },
+    { "field", 1, 1, field_find },
+    { "hpa", 0, 1, hpa_find },
+};
+static const int planner_count = sizeof(planners)/sizeof(*planners);
+
+// Return the breadth-first distance from start to goal, or -1 if the goal
+// can't be reached.
+static int reference(corpus *c, const search_cell_t *start,
+        const search_cell_t *goal)
+{
+    static const int moves[][2] = {{-1,0},{1,0},{0,-1},{0,1}};
+    const search_map_t *map = &c->map;
+    const int dim_x = map->dim_x;
+    const int dim_y = map->dim_y;
+    std::fill(c->distance.begin(), c->distance.end(), -1);
+    const int s = start->x + (dim_x*start->y);
+    const int g = goal->x + (dim_x*goal->y);
+    int head = 0, tail = 0;
+    c->queue[tail++] = s;
+    c->distance[s] = 0;
+    while ((head < tail) && (c->distance[g] < 0)) {
+        const int i = c->queue[head++];
+        const int x = i % dim_x;
+        const int y = i / dim_x;
+        for (int m = 0; m < 4; ++m) {
+            const int nx = x + moves[m][0];
+            const int ny = y + moves[m][1];
+            if ((nx < 0) || (ny < 0) || (nx >= dim_x) || (ny >= dim_y)) {
+                continue;
+            }
+            const int n = nx + (dim_x*ny);
+            if (map->cells[n].blocked || (c->distance[n] >= 0)) {
+                continue;
+            }
+            c->distance[n] = c->distance[i] + 1;
+            c->queue[tail++] = n;
+        }
+    }
+    return c->distance[g];
+}
+
+// Return non-zero if the path is unbroken from start to goal.
+static int path_valid(corpus *c, const search_cell_t *start,
+        const search_cell_t *goal)
+{
+    const search_path_t *path = &c->path;
+    int x = path->start_x;
+    int y = path->start_y;
+    if ((x != start->x) || (y != start->y)) {
+        return 0;
+    }
+    for (int i = 0; i < path->length; ++i) {
+        search_path_step(search_path_move(path, i), &x, &y);
+        if ((x < 0) || (y < 0) || (x >= c->map.dim_x) ||
+                (y >= c->map.dim_y)) {
+            return 0;
+        }
+        if (search_cell_at(&c->map, x, y)->blocked) {
+            return 0;
+        }
+    }
+    return (x == goal->x) && (y == goal->y);
+}
+
+// Allocate the planners for a map of the given size, every cell open.
+static int corpus_alloc(corpus *c, int dim_x, int dim_y)
+{
+    if (search_map_alloc(&c->map, dim_x, dim_y)) {
+        return 1;
+    }
+    memset(&c->stats, 0, sizeof(c->stats));
+    c->map.stats = &c->stats;
+    if (search_path_alloc(&c->path, dim_x*dim_y)) {
+        search_map_free(&c->map);
+        return 1;
+    }
+    if (search_field_alloc(&c->field, dim_x, dim_y)) {
+        search_path_free(&c->path);
+        search_map_free(&c->map);
+        return 1;
+    }
+    if (search_bidir_alloc(&c->bidir, &c->map)) {
+        search_field_free(&c->field);
+        search_path_free(&c->path);
+        search_map_free(&c->map);
+        return 1;
+    }
+    if (search_hpa_alloc(&c->hpa, &c->map, 16)) {
+        search_bidir_free(&c->bidir);
+        search_field_free(&c->field);
+        search_path_free(&c->path);
+        search_map_free(&c->map);
+        return 1;
+    }
+    if (search_dstar_alloc(&c->dstar, &c->map, 1, 0)) {
+        search_hpa_free(&c->hpa);
+        search_bidir_free(&c->bidir);
+        search_field_free(&c->field);
+        search_path_free(&c->path);
+        search_map_free(&c->map);
+        return 1;
+    }
+    c->distance.assign(dim_x*dim_y, -1);
+    c->queue.assign(dim_x*dim_y, 0);
+    return 0;
+}
+
+static void corpus_free(corpus *c)
+{
+    search_dstar_free(&c->dstar);
+    search_hpa_free(&c->hpa);
+    search_bidir_free(&c->bidir);
+    search_field_free(&c->field);
+    search_path_free(&c->path);
+    search_map_free(&c->map);
+}
+
+// Load a Moving AI map. Only '.', 'G' and 'S' cells are open.
+static int load_map(corpus *c, const std::string &name)
+{
+    FILE *file = fopen(name.c_str(), "r");
+    if (!file) {
+        fprintf(stderr, "can't open %s\n", name.c_str());
+        return 1;
+    }
+    char key[32];
+    int dim_x = 0, dim_y = 0;
+    for (;;) {
+        if (fscanf(file, "%31s", key) != 1) {
+            fprintf(stderr, "bad map header %s\n", name.c_str());
+            fclose(file);
+            return 1;
+        }
+        if (!strcmp(key, "map")) {
+            break;
+        }
+        if (!strcmp(key, "height")) {
+            fscanf(file, "%d", &dim_y);
+        } else if (!strcmp(key, "width")) {
+            fscanf(file, "%d", &dim_x);
+        } else {
+            fscanf(file, "%31s", key);
+        }
+    }
+    if ((dim_x <= 0) || (dim_y <= 0) || corpus_alloc(c, dim_x, dim_y)) {
+        fprintf(stderr, "bad map size %s\n", name.c_str());
+        fclose(file);
+        return 1;
+    }
+    // A short file leaves the rest of the map blocked.
+    for (int y = 0; y < dim_y; ++y) {
+        for (int x = 0; x < dim_x; ++x) {
+            char t = '@';
+            if (fscanf(file, " %c", &t) != 1) {
+                t = '@';
+            }
+            const int open = (t == '.') || (t == 'G') || (t == 'S');
+            search_map_set_blocked(&c->map, search_cell_at(&c->map, x, y),
+                    !open);
+        }
+    }
+    fclose(file);
+    return 0;
+}
+
+// Load an arena snapshot.
+static int load_snapshot(corpus *c, const std::string &name)
+{
+    search_snapshot_file_t file;
+    if (search_snapshot_open(&file, name.c_str())) {
+        return 1;
+    }
+    const search_bits_t *bits = &file.bits;
+    if (corpus_alloc(c, bits->dim_x, bits->dim_y)) {
+        search_snapshot_close(&file);
+        return 1;
+    }
+    for (int y = 0; y < bits->dim_y; ++y) {
+        for (int x = 0; x < bits->dim_x; ++x) {
+            search_map_set_blocked(&c->map, search_cell_at(&c->map, x, y),
+                    search_bits_test(bits, x, y));
+        }
+    }
+    search_snapshot_close(&file);
+    return 0;
+}
+
+// Pick start and goal pairs between open cells. Fewer are picked if there's
+// no open cell.
+static void pick_queries(corpus *c, std::vector<int> &queries)
+{
+    const search_map_t *map = &c->map;
+    std::vector<int> open;
+    for (int i = 0; i < map->dim_x*map->dim_y; ++i) {
+        if (!map->cells[i].blocked) {
+            open.push_back(i);
+        }
+    }
+    if (open.empty()) {
+        return;
+    }
+    srand(237);
+    for (int i = 0; i < random_queries; ++i) {
+        const int s = open[rand() % open.size()];
+        const int g = open[rand() % open.size()];
+        queries.push_back(s % map->dim_x);
+        queries.push_back(s / map->dim_x);
+        queries.push_back(g % map->dim_x);
+        queries.push_back(g / map->dim_x);
+    }
+}
+
+static std::string base_name(const std::string &name)
+{
+    const size_t slash = name.rfind('/');
+    return (slash == std::string::npos) ? name : name.substr(slash+1);
+}
+
+static std::string dir_name(const std::string &name)
+{
+    const size_t slash = name.rfind('/');
+    return (slash == std::string::npos) ? "." : name.substr(0, slash);
+}
+
+static int has_suffix(const std::string &name, const char *suffix)
+{
+    const size_t length = strlen(suffix);
+    return (name.size() >= length) &&
+        !name.compare(name.size() - length, length, suffix);
+}
+
+// The counts for one planner's row.
+struct tally {
+    long long elapsed_ns;
+    long expanded_total, length_total, reference_total;
+    int queries, found, missed, invalid, suboptimal;
+
+    // set if the planner can't count its expansions.
+    int uncounted;
+};
+
+// Check a plan against the breadth-first distance from start to goal, -1 if
+// the goal can't be reached, and count it. status is the planner's, and
+// threaded is set if it threaded the path through the cells.
+static void check(corpus *c, search_cell_t *start, const search_cell_t *goal,
+        int status, int threaded, int shortest, tally *t)
+{
+    ++t->queries;
+    if (shortest > 0) {
+        t->reference_total += shortest;
+    }
+    if (!status && threaded && search_path_copy(&c->path, start)) {
+        ++t->invalid;
+        return;
+    }
+    if (status) {
+        t->missed += (shortest >= 0);
+        return;
+    }
+    ++t->found;
+    if (shortest < 0) {
+        ++t->missed;
+        return;
+    }
+    if (!path_valid(c, start, goal)) {
+        ++t->invalid;
+        return;
+    }
+    t->length_total += c->path.length;
+    t->suboptimal += (c->path.length > shortest);
+}
+
+// Print a planner's row, and return its regressions.
+static long report(corpus *c, const std::string &name, const char *planner,
+        int optimal, const tally &t)
+{
+    const int count = t.queries;
+    printf("map %s dim %dx%d planner %s optimal %d queries %d found %d "
+            "ns/query %lld expanded/query %ld length_total %ld "
+            "reference_total %ld missed %d invalid %d suboptimal %d\n",
+            name.c_str(), c->map.dim_x, c->map.dim_y, planner, optimal,
+            count, t.found, count ? (t.elapsed_ns/count) : 0,
+            t.uncounted ? -1 : (count ? (t.expanded_total/count) : 0),
+            t.length_total, t.reference_total, t.missed, t.invalid,
+            t.suboptimal);
+    return t.missed + t.invalid + (optimal ? t.suboptimal : 0);
+}
+
+// Plan each query with D* Lite, then drive part way along the path and flip
+// a cell near the robot between blocked and open, replanning after each.
+// D* is allocated without a turn cost here, so its paths can be checked
+// against the breadth-first reference. Returns the regressions.
+static long run_dstar(corpus *c, const std::string &name,
+        const std::vector<int> &queries)
+{
+    search_map_t *map = &c->map;
+    const int count = queries.size()/4;
+    tally t;
+    memset(&t, 0, sizeof(t));
+    std::vector<int> flipped;
+    srand(311);
+    for (int i = 0; i < count; ++i) {
+        const int *q = &queries[4*i];
+        search_cell_t *start = search_cell_at(map, q[0], q[1]);
+        search_cell_t *goal = search_cell_at(map, q[2], q[3]);
+        int heading = search_heading_forward;
+        search_dstar_initialize(&c->dstar, start, heading, goal,
+                search_heading_any);
+        flipped.clear();
+        for (int u = 0; ; ++u) {
+            long long begin = now_ns();
+            const int status = search_dstar_find(&c->dstar, start, heading);
+            t.elapsed_ns += now_ns() - begin;
+            t.expanded_total += c->stats.last.expanded;
+            check(c, start, goal, status, 1, reference(c, start, goal), &t);
+            if (u == dstar_updates) {
+                break;
+            }
+
+            // Drive along the path, then change a cell the robot might
+            // bump into next, sparing the robot's cell and the goal.
+            if (!status && (c->path.start_x == start->x) &&
+                    (c->path.start_y == start->y)) {
+                int x = start->x;
+                int y = start->y;
+                for (int k = 0; (k < dstar_steps) && (k < c->path.length); ++k) {
+                    heading = search_path_move(&c->path, k);
+                    search_path_step(heading, &x, &y);
+                }
+                start = search_cell_at(map, x, y);
+            }
+            const int x = start->x + (rand() % ((2*dstar_reach)+1)) - dstar_reach;
+            const int y = start->y + (rand() % ((2*dstar_reach)+1)) - dstar_reach;
+            if ((x < 0) || (y < 0) || (x >= map->dim_x) || (y >= map->dim_y)) {
+                continue;
+            }
+            search_cell_t *cell = search_cell_at(map, x, y);
+            if ((cell == start) || (cell == goal)) {
+                continue;
+            }
+            flipped.push_back(cell - map->cells);
+            flipped.push_back(cell->blocked);
+            begin = now_ns();
+            search_update_cell(&c->dstar, cell, !cell->blocked);
+            t.elapsed_ns += now_ns() - begin;
+        }
+
+        // Put the map back for the next query, last change first.
+        for (int k = flipped.size()-2; k >= 0; k -= 2) {
+            search_map_set_blocked(map, &map->cells[flipped[k]],
+                    flipped[k+1]);
+        }
+    }
+    return report(c, name, "dstar", 1, t);
+}
+
+// Run every planner over the queries, and return the regressions.
+static long run(corpus *c, const std::string &name,
+        const std::vector<int> &queries)
+{
+    const int count = queries.size()/4;
+    std::vector<int> shortest(count);
+    for (int i = 0; i < count; ++i) {
+        const int *q = &queries[4*i];
+        shortest[i] = reference(c, search_cell_at(&c->map, q[0], q[1]),
+                search_cell_at(&c->map, q[2], q[3]));
+    }
+
+    // Build the hierarchical planner's cache up front, so the first query
+    // isn't charged for it.
+    search_hpa_update(&c->hpa);
+
+    long regressions = 0;
+    for (int p = 0; p < planner_count; ++p) {
+        const planner *planner = &planners[p];
+        tally t;
+        memset(&t, 0, sizeof(t));
+        for (int i = 0; i < count; ++i) {
+            const int *q = &queries[4*i];
+            search_cell_t *start = search_cell_at(&c->map, q[0], q[1]);
+            search_cell_t *goal = search_cell_at(&c->map, q[2], q[3]);
+
+            int expanded = 0;
+            const long long begin = now_ns();
+            const int status = planner->find(c, start, goal, &expanded);
+            t.elapsed_ns += now_ns() - begin;
+            if (expanded < 0) {
+                t.uncounted = 1;
+            } else {
+                t.expanded_total += expanded;
+            }
+            check(c, start, goal, status, planner->threaded, shortest[i], &t);
+        }
+        regressions += report(c, name, planner->name, planner->optimal, t);
+    }
+    return regressions + run_dstar(c, name, queries);
+}
+
+// Run a scenario's queries, loading each map it names in turn.
+// Returns the regressions, or -1 if the scenario can't be read.
+static long run_scenario(const std::string &name, int *maps, long *total)
+{
+    FILE *file = fopen(name.c_str(), "r");
+    if (!file) {
+        fprintf(stderr, "can't open %s\n", name.c_str());
+        return -1;
+    }
+    long regressions = 0;
+    corpus c;
+    std::string loaded;
+    std::vector<int> queries;
+    char line[1024], map_name[512];
+    while (fgets(line, sizeof(line), file)) {
+        int bucket, dim_x, dim_y, q[4];
+        double optimal;
+        if (sscanf(line, "%d %511s %d %d %d %d %d %d %lf", &bucket, map_name,
+                    &dim_x, &dim_y, &q[0], &q[1], &q[2], &q[3],
+                    &optimal) != 9) {
+            continue;
+        }
+
+        // Finish the last map before moving to the next.
+        if (loaded != map_name) {
+            if (!loaded.empty()) {
+                regressions += run(&c, base_name(loaded), queries);
+                *total += queries.size()/4;
+                corpus_free(&c);
+            }
+            queries.clear();
+            loaded = map_name;
+            std::string path = dir_name(name) + "/" + map_name;
+            FILE *probe = fopen(path.c_str(), "r");
+            if (probe) {
+                fclose(probe);
+            } else {
+                path = dir_name(name) + "/" + base_name(map_name);
+            }
+            if (load_map(&c, path)) {
+                fclose(file);
+                return -1;
+            }
+            ++*maps;
+        }
+        if ((q[0] >= c.map.dim_x) || (q[1] >= c.map.dim_y) ||
+                (q[2] >= c.map.dim_x) || (q[3] >= c.map.dim_y)) {
+            fprintf(stderr, "query off the map %s\n", line);
+            continue;
+        }
+        queries.insert(queries.end(), q, q+4);
+    }
+    fclose(file);
+    if (!loaded.empty()) {
+        regressions += run(&c, base_name(loaded), queries);
+        *total += queries.size()/4;
+        corpus_free(&c);
+    }
+    return regressions;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s file.scen|file.map|file.smap ...\n",
+                argv[0]);
+        return 2;
+    }
+
+    long regressions = 0, queries = 0;
+    int maps = 0, failed = 0;
+    for (int a = 1; a < argc; ++a) {
+        const std::string name = argv[a];
+        if (has_suffix(name, ".scen")) {
+            const long r = run_scenario(name, &maps, &queries);
+            if (r < 0) {
+                ++failed;
+            } else {
+                regressions += r;
+            }
+            continue;
+        }
+
+        corpus c;
+        const int status = has_suffix(name, ".smap") ?
+            load_snapshot(&c, name) : load_map(&c, name);
+        if (status) {
+            ++failed;
+            continue;
+        }
+        std::vector<int> q;
+        pick_queries(&c, q);
+        regressions += run(&c, base_name(name), q);
+        queries += q.size()/4;
+        ++maps;
+        corpus_free(&c);
+    }
+    printf("corpus maps %d queries %ld failed %d regressions %ld\n", maps,
+            queries, failed, regressions);
+    return (failed || regressions) ? 1 : 0;
+}
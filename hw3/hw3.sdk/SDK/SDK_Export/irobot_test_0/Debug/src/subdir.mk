@@ -13,7 +13,19 @@ C_SRCS += \
 ../src/uart.c 
 
 CC_SRCS += \
-../src/search.cc 
+../src/search.cc \
+../src/search_bits.cc \
+../src/search_coverage.cc \
+../src/search_cspace.cc \
+../src/search_dstar.cc \
+../src/search_field.cc \
+../src/search_frontier.cc \
+../src/search_lattice.cc \
+../src/search_occupancy.cc \
+../src/search_path.cc \
+../src/search_route.cc \
+../src/search_snapshot.cc \
+../src/search_stats.cc 
 
 LD_SRCS += \
 ../src/lscript.ld 
@@ -26,7 +38,19 @@ OBJS += \
 ./src/platform.o \
 ./src/ssd1306.o \
 ./src/uart.o  \
-./src/search.o 
+./src/search.o \
+./src/search_bits.o \
+./src/search_coverage.o \
+./src/search_cspace.o \
+./src/search_dstar.o \
+./src/search_field.o \
+./src/search_frontier.o \
+./src/search_lattice.o \
+./src/search_occupancy.o \
+./src/search_path.o \
+./src/search_route.o \
+./src/search_snapshot.o \
+./src/search_stats.o 
 
 C_DEPS += \
 ./src/gpio.d \
@@ -34,6 +58,18 @@ C_DEPS += \
 ./src/irobot.d \
 ./src/platform.d \
 ./src/search.d \
+./src/search_bits.d \
+./src/search_coverage.d \
+./src/search_cspace.d \
+./src/search_dstar.d \
+./src/search_field.d \
+./src/search_frontier.d \
+./src/search_lattice.d \
+./src/search_occupancy.d \
+./src/search_path.d \
+./src/search_route.d \
+./src/search_snapshot.d \
+./src/search_stats.d \
 ./src/ssd1306.d \
 ./src/uart.d 
 
@@ -49,7 +85,7 @@ src/%.o: ../src/%.c
 src/%.o: ../src/%.cc
 	@echo 'Building file: $<'
 	@echo 'Invoking: ARM g++ compiler'
-	arm-xilinx-eabi-g++ -Wall -O0 -g3 -c -fmessage-length=0 -I../../standalone_bsp_0/ps7_cortexa9_0/include -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@:%.o=%.d)" -o "$@" "$<"
+	arm-xilinx-eabi-g++ -Wall -O0 -g3 -c -fmessage-length=0 -mfpu=neon -mfloat-abi=softfp -I../../standalone_bsp_0/ps7_cortexa9_0/include -MMD -MP -MF"$(@:%.o=%.d)" -MT"$(@:%.o=%.d)" -o "$@" "$<"
 	@echo 'Finished building: $<'
 	@echo ' '
 
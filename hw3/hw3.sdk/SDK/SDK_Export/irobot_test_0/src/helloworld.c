@@ -2,6 +2,7 @@
 // Tristan Monroe <twmonroe@eng.ucsd.edu>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <xtime_l.h>
 #include "platform.h"
@@ -13,14 +14,236 @@
 #include "font_5x7.h"
 #include "Inspire.h"
 #include "search.h"
+#include "search_field.h"
+#include "search_frontier.h"
+#include "search_route.h"
+#include "search_coverage.h"
+#include "search_lattice.h"
+#include "search_path.h"
+#include "search_snapshot.h"
 
 // Menu context.
 typedef struct {
     search_map_t *map;
+    search_dstar_t *dstar;
+    search_field_t *field;
+    search_lattice_t *lattice;
+    search_path_t *path;
+    search_cspace_t *cspace;
+    search_occupancy_t *occupancy;
+    search_frontier_t *frontier;
+    search_coverage_t *coverage;
     uart_t *uart;
     ssd1306_t *oled[2];
+
+    // the last snapshot of the known obstacles, loaded at power on or
+    // written by the last run, and scratch space for building the next one.
+    unsigned char *snapshot;
+    size_t snapshot_size;
+    search_bits_t *known;
 } menu_context_t;
 
+// Seed the configuration space with the obstacles earlier runs found, so a
+// run starts from what's known about the arena rather than from nothing.
+// Older evidence counts for less each run, so obstacles that aren't seen
+// again fade away.
+static void arena_restore(menu_context_t *menu_context)
+{
+    search_map_t *map = menu_context->map;
+    search_occupancy_t *occupancy = menu_context->occupancy;
+    printf("forgot %d obstacles\n",
+            search_occupancy_decay(occupancy, irobot_odds_decay_shift));
+    int x, y, count = 0;
+    for (y = 0; y < map->dim_y; ++y) {
+        for (x = 0; x < map->dim_x; ++x) {
+            if (search_occupancy_occupied(occupancy, x, y)) {
+                search_cspace_set(menu_context->cspace, x, y, 1);
+                ++count;
+            }
+        }
+    }
+    printf("restored %d obstacles\n", count);
+}
+
+// Remember the obstacles found so far, and print the snapshot on the console
+// so it can be kept off the board with map-snapshot.
+static void snapshot_save(menu_context_t *menu_context)
+{
+    search_map_t *map = menu_context->map;
+    search_occupancy_t *occupancy = menu_context->occupancy;
+    search_bits_t *known = menu_context->known;
+    search_bits_clear(known);
+    int x, y;
+    for (y = 0; y < map->dim_y; ++y) {
+        for (x = 0; x < map->dim_x; ++x) {
+            if (search_occupancy_occupied(occupancy, x, y)) {
+                search_bits_set(known, x, y, 1);
+            }
+        }
+    }
+
+    // Count this run on top of the ones already in the snapshot.
+    search_bits_t previous;
+    unsigned runs = 0;
+    search_snapshot_view(menu_context->snapshot, menu_context->snapshot_size,
+            &previous, &runs);
+    search_snapshot_write(known, runs+1, menu_context->snapshot,
+            menu_context->snapshot_size);
+
+    printf("snapshot begin %d\n", (int)menu_context->snapshot_size);
+    size_t i;
+    for (i = 0; i < menu_context->snapshot_size; ++i) {
+        if (!(i%32)) {
+            printf("snapshot ");
+        }
+        printf("%02x", menu_context->snapshot[i]);
+        if (((i%32) == 31) || ((i+1) == menu_context->snapshot_size)) {
+            printf("\n");
+        }
+    }
+    printf("snapshot end\n");
+}
+
+// How long to wait at power on for each line of a snapshot.
+#define snapshot_load_wait_s 5
+
+// Read a line from the console, without its line ending, waiting up to
+// snapshot_load_wait_s for the whole line. A line longer than the buffer is
+// truncated.
+// Returns the length of the line, or -1 on timeout.
+static int console_line(uart_t *console, char *line, int size)
+{
+    int n = 0;
+    XTime deadline;
+    XTime_GetTime(&deadline);
+    deadline += snapshot_load_wait_s*COUNTS_PER_SECOND;
+    for (;;) {
+        if (!uart_recv_ready(console)) {
+            XTime now;
+            XTime_GetTime(&now);
+            if (now >= deadline) {
+                return -1;
+            }
+            continue;
+        }
+        const char c = uart_recv(console);
+        if (c == '\n') {
+            break;
+        }
+        if ((c != '\r') && (n < (size-1))) {
+            line[n++] = c;
+        }
+    }
+    line[n] = 0;
+    return n;
+}
+
+// Return the value of a hex digit, or -1.
+static int hex_value(char c)
+{
+    if ((c >= '0') && (c <= '9')) {
+        return c - '0';
+    }
+    if ((c >= 'a') && (c <= 'f')) {
+        return c - 'a' + 10;
+    }
+    if ((c >= 'A') && (c <= 'F')) {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// Wait for map-snapshot send to put a snapshot on the console, in the format
+// snapshot_save prints, and seed the occupancy grid with its obstacles as if
+// each had been bumped into once. If none arrives, or it doesn't fit this
+// arena, start from nothing.
+static void snapshot_load(menu_context_t *menu_context, uart_t *console)
+{
+    search_map_t *map = menu_context->map;
+    search_occupancy_t *occupancy = menu_context->occupancy;
+    unsigned char *snapshot = menu_context->snapshot;
+    const size_t size = menu_context->snapshot_size;
+    printf("snapshot load %d\n", (int)size);
+
+    // Decode lines until a whole snapshot of the right size is in.
+    char line[96];
+    size_t used = 0;
+    int begun = 0;
+    for (;;) {
+        if (console_line(console, line, sizeof(line)) < 0) {
+            printf("no snapshot loaded\n");
+            memset(snapshot, 0, size);
+            return;
+        }
+        int bytes;
+        if (sscanf(line, "snapshot begin %d", &bytes) == 1) {
+            begun = (bytes == (int)size);
+            used = 0;
+            continue;
+        }
+        if (!strcmp(line, "snapshot end")) {
+            if (begun && (used == size)) {
+                break;
+            }
+            begun = 0;
+            continue;
+        }
+        if (!begun || strncmp(line, "snapshot ", strlen("snapshot "))) {
+            continue;
+        }
+        const char *p = line + strlen("snapshot ");
+        for (;;) {
+            const int hi = hex_value(p[0]);
+            const int lo = (hi < 0) ? -1 : hex_value(p[1]);
+            if (lo < 0) {
+                break;
+            }
+            if (used == size) {
+                begun = 0;
+                break;
+            }
+            snapshot[used++] = (unsigned char)((hi << 4) | lo);
+            p += 2;
+        }
+    }
+
+    // The buffer is calloc'd, so it's aligned for search_snapshot_view.
+    search_bits_t bits;
+    unsigned runs = 0;
+    if (search_snapshot_view(snapshot, size, &bits, &runs) ||
+            (bits.dim_x != map->dim_x) || (bits.dim_y != map->dim_y)) {
+        printf("invalid snapshot\n");
+        memset(snapshot, 0, size);
+        return;
+    }
+    int x, y, count = 0;
+    for (y = 0; y < map->dim_y; ++y) {
+        for (x = 0; x < map->dim_x; ++x) {
+            if (search_bits_test(&bits, x, y)) {
+                search_occupancy_update(occupancy, x, y, irobot_odds_bump);
+                ++count;
+            }
+        }
+    }
+    printf("loaded %d obstacles from %u runs\n", count, runs);
+}
+
+// The planner's clock.
+static uint64_t stats_clock(void)
+{
+    XTime now;
+    XTime_GetTime(&now);
+    return now;
+}
+
+// Print what the run's searches cost, and start counting afresh.
+static void stats_dump(menu_context_t *menu_context)
+{
+    search_stats_t *stats = menu_context->map->stats;
+    search_stats_print(stats, COUNTS_PER_SECOND/1000000);
+    search_stats_clear(stats);
+}
+
 // Menu handlers.
 void handler_programmed_route(void *context)
 {
@@ -29,43 +252,63 @@ void handler_programmed_route(void *context)
     uart_t *uart = menu_context->uart;
     ssd1306_t *oled = menu_context->oled[1];
     search_map_t *map = menu_context->map;
+    search_dstar_t *dstar = menu_context->dstar;
+    search_lattice_t *lattice = menu_context->lattice;
+    search_path_t *path = menu_context->path;
+    search_cspace_t *cspace = menu_context->cspace;
+    search_occupancy_t *occupancy = menu_context->occupancy;
 
     // clear the display
     ssd1306_clear(oled);
 
     // Verify we can find our goal.
     // We assume each time the programmed route is run, there could be new
-    // obstacles, so we clear the map of obstacles.
+    // obstacles, so we clear the map of obstacles, starting again from those
+    // earlier runs found, which fade unless they're seen again.
     printf("programmed route\n");
     search_map_initialize(map,1);
+    search_cspace_clear(cspace);
+    arena_restore(menu_context);
     search_cell_t *start = search_cell_at(map,0,0);
-    search_cell_t *goal = search_cell_at(map,(128/8)/2,(64/8)/2);
-    search_find(map, start, goal);
-    if (!goal->closed) {
+    search_cell_t *goal = search_cell_at(map,search_arena_dim_x/2,search_arena_dim_y/2);
+
+    // A restored obstacle mustn't inflate over either end.
+    search_cspace_exempt(cspace, start, goal);
+    if ((search_lattice_find(lattice, start, search_heading_forward, goal,
+                search_heading_forward) < 0) || search_path_copy(path, start)) {
         printf("panic: could not find goal!\n");
         return;
     }
-    irobot_move(uart, oled, map, start, goal, 0);
+    irobot_move(uart, oled, map, dstar, cspace, occupancy, 0, path, goal, 0);
 
-    // Reset the map to find a new goal, but don't clear obstacle memory.
-    search_map_initialize(map,0);
-    search_find(map, goal, start);
-    if (!goal->closed) {
+    // Find the way back, keeping obstacle memory.
+    search_cspace_exempt(cspace, goal, start);
+    if ((search_lattice_find(lattice, goal, search_heading_forward, start,
+                search_heading_forward) < 0) || search_path_copy(path, goal)) {
         printf("panic: could not find goal!\n");
         return;
     }
-    irobot_move(uart, oled, map, goal, start, 0);
+    irobot_move(uart, oled, map, dstar, cspace, occupancy, 0, path, start, 0);
+    snapshot_save(menu_context);
+    stats_dump(menu_context);
 }
 
 // Move through all the user defined waypoints. At each waypoint, play a song.
 // When finished with the user waypoints, return to base. This assumes the
-// starting location is (0,0).
+// starting location is (0,0). The waypoints are visited in whichever order
+// makes the shortest round trip, not the order they were entered.
 void handler_user_route(int *coords, int count, void *context)
 {
     menu_context_t *menu_context = (menu_context_t*)context;
     uart_t *uart = menu_context->uart;
     ssd1306_t *oled = menu_context->oled[1];
     search_map_t *map = menu_context->map;
+    search_dstar_t *dstar = menu_context->dstar;
+    search_field_t *field = menu_context->field;
+    search_lattice_t *lattice = menu_context->lattice;
+    search_path_t *path = menu_context->path;
+    search_cspace_t *cspace = menu_context->cspace;
+    search_occupancy_t *occupancy = menu_context->occupancy;
 
     // clear the display
     ssd1306_clear(oled);
@@ -74,38 +317,68 @@ void handler_user_route(int *coords, int count, void *context)
     search_cell_t *start = search_cell_at(map,0,0);
     search_cell_t *goal = 0;
 
+    // clear obstacle memory only on start;
+    // subsequent waypoints should retain obstacle memory.
+    search_map_initialize(map,1);
+    search_cspace_clear(cspace);
+    arena_restore(menu_context);
+    search_cspace_exempt(cspace, start, 0);
+
+    // order the waypoints, in cells.
+    int *waypoints = (int*)malloc(sizeof(int)*3*count);
+    if (!waypoints) {
+        printf("malloc failed\n");
+        return;
+    }
+    int *order = &waypoints[2*count];
+    int i;
+    for (i = 0; i < 2*count; ++i) {
+        waypoints[i] = coords[i]/8;
+    }
+    int length = 0;
+    if (search_route_order(map, field, start->x, start->y, waypoints, count,
+                order, &length)) {
+        printf("search_route_order failed\n");
+        free(waypoints);
+        return;
+    }
+    printf("route length: %d\n", length);
+
     // for each waypoint, move to the waypoint and play a song.
     // finally, return to base.
-    int i;
     for (i = 0; i < count; ++i) {
-        const int x = coords[(2*i)]/8;
-        const int y = coords[(2*i)+1]/8;
+        const int x = waypoints[(2*order[i])];
+        const int y = waypoints[(2*order[i])+1];
         printf("waypoint x:%d y:%d\n", x, y);
         goal = search_cell_at(map,x,y);
 
-        // search and move
-        // clear obstacle memory only on start;
-        // subsequent waypoints should retain obstacle memory.
-        search_map_initialize(map,i==0);
-        search_find(map, start, goal);
-        if (!goal->closed) {
+        // search and move, minimizing drive time.
+        search_cspace_exempt(cspace, start, goal);
+        if ((search_lattice_find(lattice, start, search_heading_forward, goal,
+                    search_heading_forward) < 0) ||
+                search_path_copy(path, start)) {
             printf("panic: could not find goal!\n");
+            free(waypoints);
             return;
         }
-        irobot_move(uart, oled, map, start, goal, 0);
+        irobot_move(uart, oled, map, dstar, cspace, occupancy, 0, path, goal,
+                0);
         irobot_play_song(uart, 0);
         start = goal;
     }
+    free(waypoints);
 
     // search and return to base
     goal = search_cell_at(map,0,0);
-    search_map_initialize(map,0);
-    search_find(map, start, goal);
-    if (!goal->closed) {
+    search_cspace_exempt(cspace, start, goal);
+    if ((search_lattice_find(lattice, start, search_heading_forward, goal,
+                search_heading_forward) < 0) || search_path_copy(path, start)) {
         printf("panic: could not find goal!\n");
         return;
     }
-    irobot_move(uart, oled, map, start, goal, 0);
+    irobot_move(uart, oled, map, dstar, cspace, occupancy, 0, path, goal, 0);
+    snapshot_save(menu_context);
+    stats_dump(menu_context);
 }
 
 // This will scan an arena for obstacles.
@@ -116,22 +389,45 @@ void handler_search(int time_s, void *context)
     uart_t *uart = menu_context->uart;
     ssd1306_t *oled = menu_context->oled[1];
     search_map_t *map = menu_context->map;
+    search_dstar_t *dstar = menu_context->dstar;
+    search_field_t *field = menu_context->field;
+    search_lattice_t *lattice = menu_context->lattice;
+    search_path_t *path = menu_context->path;
+    search_cspace_t *cspace = menu_context->cspace;
+    search_occupancy_t *occupancy = menu_context->occupancy;
+    search_frontier_t *frontier = menu_context->frontier;
 
     // clear the display
     ssd1306_clear(oled);
 
     printf("search: %d\n", time_s);
     search_map_initialize(map,1);
+    search_cspace_clear(cspace);
+    arena_restore(menu_context);
+    search_frontier_rebuild(frontier);
 
     XTime time_start;
     XTime_GetTime(&time_start);
     int elapsed_s = 0;
 
-    // Start from home.
+    // Start from home, which we're standing on, so it's free, and a restored
+    // obstacle mustn't inflate over it.
     search_cell_t *goal = 0;
     search_cell_t *start = search_cell_at(map,0,0);
+    if (search_occupancy_update(occupancy, start->x, start->y,
+                irobot_odds_traversed)) {
+        search_cspace_set(cspace, start->x, start->y, 0);
+    }
+    search_cspace_exempt(cspace, start, 0);
+
+    // One distance field from where we are answers every goal, so goals are
+    // picked and rejected without a search of their own. The field is only
+    // recomputed once we've moved, which is also when the map can change.
+    search_distance_field(field, map, start->x, start->y);
 
-    // Seek out unobstructed random waypoints until we are out of time.
+    // Drive to the frontier between what's known and what isn't, where each
+    // second of driving is likely to turn up the most, until there's nothing
+    // left we can reach or we're out of time.
     for (;;) {
 
         // Check for timeout.
@@ -144,15 +440,30 @@ void handler_search(int time_s, void *context)
         }
 
         // Pick the next scanning goal.
-        // This could simply be a random point.
-        goal = search_cell_at(map,rand()%(128/8), rand()%(64/8));
-        if (goal->blocked) {
-            printf("ignoring blocked goal %d,%d\n", goal->x, goal->y);
+        int x, y;
+        if (search_frontier_pick(frontier, field, irobot_cell_ms,
+                    irobot_turn_ms, &x, &y)) {
+            printf("search complete (elapsed %ds)\n", elapsed_s);
+            break;
+        }
+        goal = search_cell_at(map, x, y);
+        if (search_field_path(field, map, goal) ||
+                search_path_copy(path, start)) {
+            printf("ignoring unreachable goal %d,%d\n", goal->x, goal->y);
+            search_frontier_reject(frontier, goal->x, goal->y);
             continue;
         }
-        search_map_initialize(map,0);
-        search_find(map, start, goal);
-        start = irobot_move(uart, oled, map, start, goal, time_s-elapsed_s);
+
+        // If we couldn't get anywhere, the goal's out of reach for now.
+        search_cell_t *end = irobot_move(uart, oled, map, dstar, cspace,
+                occupancy, 0, path, goal, time_s-elapsed_s);
+        if (end == start) {
+            printf("giving up on goal %d,%d\n", goal->x, goal->y);
+            search_frontier_reject(frontier, goal->x, goal->y);
+        }
+        start = end;
+        search_cspace_exempt(cspace, start, 0);
+        search_distance_field(field, map, start->x, start->y);
     }
 
     // We're done searching!
@@ -160,9 +471,162 @@ void handler_search(int time_s, void *context)
 
     // Return home taking as long as necessary.
     goal = search_cell_at(map,0,0);
-    search_map_initialize(map,0);
-    search_find(map,start,goal);
-    irobot_move(uart, oled, map, start, goal, 0);
+    search_cspace_exempt(cspace, start, goal);
+    if ((search_lattice_find(lattice, start, search_heading_forward, goal,
+                search_heading_forward) < 0) || search_path_copy(path, start)) {
+        printf("panic: could not find goal!\n");
+        return;
+    }
+    irobot_move(uart, oled, map, dstar, cspace, occupancy, 0, path, goal, 0);
+    snapshot_save(menu_context);
+    stats_dump(menu_context);
+}
+
+// Sweep every reachable cell of the arena, lane by lane, for up to time_s.
+// Each pass plans the sweep of what's left from where the robot is, and
+// chains as many lanes as fit into a single path, so the robot doesn't stop
+// and turn back to forward between them. New obstacles only rebuild the
+// lanes they're in.
+void handler_sweep(int time_s, void *context)
+{
+    menu_context_t *menu_context = (menu_context_t*)context;
+    uart_t *uart = menu_context->uart;
+    ssd1306_t *oled = menu_context->oled[1];
+    search_map_t *map = menu_context->map;
+    search_dstar_t *dstar = menu_context->dstar;
+    search_lattice_t *lattice = menu_context->lattice;
+    search_path_t *path = menu_context->path;
+    search_cspace_t *cspace = menu_context->cspace;
+    search_occupancy_t *occupancy = menu_context->occupancy;
+    search_coverage_t *coverage = menu_context->coverage;
+
+    // clear the display
+    ssd1306_clear(oled);
+
+    printf("sweep: %d\n", time_s);
+    search_map_initialize(map,1);
+    search_cspace_clear(cspace);
+    arena_restore(menu_context);
+    printf("sweep segments: %d\n", search_coverage_decompose(coverage));
+
+    // The cells swept so far, the cells reachable from the robot, the
+    // waypoints of the sweep, and each leg between them.
+    const int cells = map->dim_x*map->dim_y;
+    search_bits_t swept, reached;
+    search_path_t leg;
+    int *coords = (int*)malloc(sizeof(int)*4*cells);
+    if (!coords) {
+        printf("malloc failed\n");
+        return;
+    }
+    if (search_bits_alloc(&swept, map->dim_x, map->dim_y)) {
+        free(coords);
+        return;
+    }
+    if (search_bits_alloc(&reached, map->dim_x, map->dim_y)) {
+        search_bits_free(&swept);
+        free(coords);
+        return;
+    }
+    if (search_path_alloc(&leg, cells)) {
+        search_bits_free(&reached);
+        search_bits_free(&swept);
+        free(coords);
+        return;
+    }
+
+    XTime time_start;
+    XTime_GetTime(&time_start);
+    int elapsed_s = 0;
+    search_cell_t *start = search_cell_at(map,0,0);
+    search_cell_t *goal = 0;
+    for (;;) {
+
+        // Check for timeout.
+        XTime time_now;
+        XTime_GetTime(&time_now);
+        elapsed_s = (time_now - time_start)/COUNTS_PER_SECOND;
+        if (elapsed_s >= time_s) {
+            printf("sweep timeout (elapsed %ds)\n", elapsed_s);
+            break;
+        }
+
+        // Catch up with any obstacles the last pass found. Cells we can't
+        // reach count as swept, so the sweep doesn't chase them.
+        printf("sweep rebuilt %d lanes\n", search_coverage_sync(coverage));
+        search_cspace_exempt(cspace, start, 0);
+        search_bits_flood(&map->bits, start->x, start->y, &reached);
+        search_bits_set(&swept, start->x, start->y, 1);
+        int x, y;
+        for (y = 0; y < map->dim_y; ++y) {
+            for (x = 0; x < map->dim_x; ++x) {
+                if (!search_bits_test(&reached, x, y)) {
+                    search_bits_set(&swept, x, y, 1);
+                }
+            }
+        }
+        const int count = search_coverage_route(coverage, &swept, start->x,
+                start->y, coords, 2*cells);
+        if (!count) {
+            printf("sweep complete (elapsed %ds)\n", elapsed_s);
+            break;
+        }
+
+        // Chain the legs to as many waypoints as the path holds.
+        search_path_clear(path, start->x, start->y);
+        x = start->x;
+        y = start->y;
+        int i, k;
+        for (i = 0; i < count; ++i) {
+            search_map_initialize(map,0);
+            if (search_find_path(map, search_cell_at(map, x, y),
+                        search_cell_at(map, coords[2*i], coords[(2*i)+1]),
+                        search_mode_astar, &leg) ||
+                    ((path->length + leg.length) > path->capacity)) {
+                break;
+            }
+            for (k = 0; k < leg.length; ++k) {
+                search_path_push(path, search_path_move(&leg, k));
+            }
+            x = coords[2*i];
+            y = coords[(2*i)+1];
+        }
+        if (!i) {
+            printf("ignoring unreachable waypoint %d,%d\n", coords[0],
+                    coords[1]);
+            search_bits_set(&swept, coords[0], coords[1], 1);
+            continue;
+        }
+        goal = search_cell_at(map, x, y);
+        search_cspace_exempt(cspace, start, goal);
+
+        // Every cell the robot reaches is swept, wherever replans take it.
+        // If it ends where it started, the first waypoint is out of reach
+        // for now.
+        search_cell_t *end = irobot_move(uart, oled, map, dstar, cspace,
+                occupancy, &swept, path, goal, time_s-elapsed_s);
+        if (end == start) {
+            printf("giving up on waypoint %d,%d\n", coords[0], coords[1]);
+            search_bits_set(&swept, coords[0], coords[1], 1);
+        }
+        start = end;
+    }
+    search_path_free(&leg);
+    search_bits_free(&reached);
+    search_bits_free(&swept);
+    free(coords);
+
+    // Return home taking as long as necessary.
+    goal = search_cell_at(map,0,0);
+    search_cspace_exempt(cspace, start, goal);
+    if ((search_lattice_find(lattice, start, search_heading_forward, goal,
+                search_heading_forward) < 0) || search_path_copy(path, start)) {
+        printf("panic: could not find goal!\n");
+        return;
+    }
+    irobot_move(uart, oled, map, dstar, cspace, occupancy, 0, path, goal, 0);
+    snapshot_save(menu_context);
+    stats_dump(menu_context);
 }
 
 // Application driver.
@@ -176,12 +640,83 @@ int main()
 
     printf("search self test\n");
     search_map_t map;
-    status = search_map_alloc(&map, 128/8, 64/8);
+    status = search_map_alloc(&map, search_arena_dim_x, search_arena_dim_y);
     if (status) {
         printf("search_map_alloc failed %d\n", status);
         return status;
     }
 
+    // Count what every search on the map costs.
+    search_stats_t stats = {
+        .clock = stats_clock,
+    };
+    map.stats = &stats;
+
+    search_dstar_t dstar;
+    status = search_dstar_alloc(&dstar, &map, irobot_cell_ms, irobot_turn_ms);
+    if (status) {
+        printf("search_dstar_alloc failed %d\n", status);
+        return status;
+    }
+    search_field_t field;
+    status = search_field_alloc(&field, map.dim_x, map.dim_y);
+    if (status) {
+        printf("search_field_alloc failed %d\n", status);
+        return status;
+    }
+    search_lattice_t lattice;
+    status = search_lattice_alloc(&lattice, &map, irobot_cell_ms,
+            irobot_turn_ms);
+    if (status) {
+        printf("search_lattice_alloc failed %d\n", status);
+        return status;
+    }
+    search_path_t path;
+    status = search_path_alloc(&path, map.dim_x*map.dim_y);
+    if (status) {
+        printf("search_path_alloc failed %d\n", status);
+        return status;
+    }
+    search_cspace_t cspace;
+    status = search_cspace_alloc(&cspace, &map, irobot_clearance_cells);
+    if (status) {
+        printf("search_cspace_alloc failed %d\n", status);
+        return status;
+    }
+    search_occupancy_t occupancy;
+    status = search_occupancy_alloc(&occupancy, map.dim_x, map.dim_y,
+            irobot_odds_occupied, irobot_odds_free);
+    if (status) {
+        printf("search_occupancy_alloc failed %d\n", status);
+        return status;
+    }
+    search_frontier_t frontier;
+    status = search_frontier_alloc(&frontier, &occupancy);
+    if (status) {
+        printf("search_frontier_alloc failed %d\n", status);
+        return status;
+    }
+    search_coverage_t coverage;
+    status = search_coverage_alloc(&coverage, &map);
+    if (status) {
+        printf("search_coverage_alloc failed %d\n", status);
+        return status;
+    }
+    search_bits_t known;
+    status = search_bits_alloc(&known, map.dim_x, map.dim_y);
+    if (status) {
+        printf("search_bits_alloc failed %d\n", status);
+        return status;
+    }
+
+    // An empty buffer holds no snapshot until the first run writes one.
+    const size_t snapshot_size = search_snapshot_bytes(map.dim_x, map.dim_y);
+    unsigned char *snapshot = (unsigned char*)calloc(snapshot_size, 1);
+    if (!snapshot) {
+        printf("calloc failed\n");
+        return 1;
+    }
+
     // Configure buttons.
     gpio_axi_t gpio_axi = {
         .id = XPAR_AXI_GPIO_0_DEVICE_ID,
@@ -271,6 +806,18 @@ int main()
         return status;
     }
 
+    // The console, where map-snapshot sends the snapshot of earlier runs.
+    // It's already running at the console's rate; this just lets us poll it.
+    uart_t uart1 = {
+        .id = XPAR_PS7_UART_1_DEVICE_ID,
+        .baud_rate = 115200,
+    };
+    status = uart_initialize(&uart1);
+    if (status) {
+        printf("uart_initialize failed %d\n", status);
+        return status;
+    }
+
     printf("uart0 mode full\n");
     const u8 cmd_mode_full[] = {128,132};
     uart_sendv(&uart0, cmd_mode_full, sizeof(cmd_mode_full));
@@ -282,14 +829,37 @@ int main()
     // Start the integrated menu.
     menu_context_t menu_context = {
         .map = &map,
+        .dstar = &dstar,
+        .field = &field,
+        .lattice = &lattice,
+        .path = &path,
+        .cspace = &cspace,
+        .occupancy = &occupancy,
+        .frontier = &frontier,
+        .coverage = &coverage,
         .uart = &uart0,
         .oled = { [0] &oled0, [1] &oled1 },
+        .snapshot = snapshot,
+        .snapshot_size = snapshot_size,
+        .known = &known,
     };
+    snapshot_load(&menu_context, &uart1);
     menu_handler_programmed_route = handler_programmed_route;
     menu_handler_user_route = handler_user_route;
     menu_handler_search = handler_search;
+    menu_handler_sweep = handler_sweep;
     menu_run(&gpio_axi, &oled0, &menu_context);
 
+    free(snapshot);
+    search_bits_free(&known);
+    search_coverage_free(&coverage);
+    search_frontier_free(&frontier);
+    search_occupancy_free(&occupancy);
+    search_cspace_free(&cspace);
+    search_path_free(&path);
+    search_lattice_free(&lattice);
+    search_field_free(&field);
+    search_dstar_free(&dstar);
     search_map_free(&map);
     return 0;
 
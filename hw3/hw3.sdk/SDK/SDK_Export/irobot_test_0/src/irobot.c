@@ -49,7 +49,8 @@ static void wait_for_interval(XTime start, int time_ms)
 }
 
 // Move in a straight line polling for obstacles.
-int irobot_drive_straight_sense(uart_t *uart, s16 distance_mm)
+int irobot_drive_straight_sense(uart_t *uart, s16 distance_mm, s16 cell_mm,
+        u8 *wall)
 {
     const int abs_speed = 100; //mm/s
     const int abs_distance = abs(distance_mm);
@@ -80,6 +81,15 @@ int irobot_drive_straight_sense(uart_t *uart, s16 distance_mm)
             break;
         }
 
+        // Note the wall against the cell we're nearest.
+        if (wall && s.wall) {
+            const int travelled_mm = (i * polling_interval_ms * abs_speed)/1000;
+            const int cell = (travelled_mm + (cell_mm/2))/cell_mm;
+            if (cell <= (abs_distance/cell_mm)) {
+                wall[cell] = 1;
+            }
+        }
+
         XTime current_clock;
         XTime_GetTime(&current_clock);
         wait_for_interval(current_clock, polling_interval_ms);
@@ -135,7 +145,7 @@ void irobot_rotate_left(uart_t *uart)
 
     // Wait for the program to complete.
     // Ideally, this would be derived from the rotational velocity.
-    usleep(1000 * 1000);
+    usleep(irobot_turn_ms * 1000);
 }
 
 // Rotate right.
@@ -158,7 +168,7 @@ void irobot_rotate_right(uart_t *uart)
 
     // Wait for the program to complete.
     // Ideally, this would be derived from the rotational velocity.
-    usleep(1000 * 1000);
+    usleep(irobot_turn_ms * 1000);
 }
 
 #define abs(x) ((x<0)?-x:x)
@@ -219,10 +229,82 @@ void irobot_rotate(uart_t *uart, direction_t direction_current, direction_t dire
     }
 }
 
+// The length of a cell, and the most cells a single drive can cover, since
+// drive distances are an s16.
+#define irobot_unit_mm (24*8) // ~8 inches
+#define irobot_run_cells (32767/irobot_unit_mm)
+
+// Send configuration space changes to the primed incremental planner.
+static void irobot_apply_dstar(void *context, search_cell_t *c, int blocked)
+{
+    search_update_cell((search_dstar_t*)context, c, blocked);
+}
+
+// What irobot_move keeps up to date as it learns about the arena.
+typedef struct {
+    ssd1306_t *oled;
+    search_map_t *map;
+    search_dstar_t *dstar;
+    int dstar_primed;
+    search_cspace_t *cspace;
+    search_occupancy_t *occupancy;
+    search_cell_t *goal;
+} irobot_world_t;
+
+// Block or unblock x,y for planning, while the robot is on here.
+static void irobot_mark(irobot_world_t *w, search_cell_t *here, int x, int y,
+        int blocked)
+{
+    search_cell_t *c = search_cell_at(w->map, x, y);
+    if (w->cspace) {
+        w->cspace->apply = w->dstar_primed ? irobot_apply_dstar : 0;
+        w->cspace->apply_context = w->dstar;
+        search_cspace_exempt(w->cspace, here, w->goal);
+        printf("inflated %d cells\n",
+                search_cspace_set(w->cspace, c->x, c->y, blocked));
+        w->cspace->apply = 0;
+        w->cspace->apply_context = 0;
+    } else if (w->dstar_primed) {
+        search_update_cell(w->dstar, c, blocked);
+    } else {
+        search_map_set_blocked(w->map, c, blocked);
+    }
+    ssd1306_display_square(w->oled, c->x*8, c->y*8,
+            blocked ? ssd1306_square_solid : ssd1306_square_blank);
+}
+
+// Add a reading's evidence about x,y to the occupancy grid, marking the cell
+// if that changes whether it counts as occupied.
+// Returns non-zero if it did.
+static int irobot_observe(irobot_world_t *w, search_cell_t *here, int x,
+        int y, int odds)
+{
+    if (!w->occupancy || !search_occupancy_update(w->occupancy, x, y, odds)) {
+        return 0;
+    }
+    const int occupied = search_occupancy_occupied(w->occupancy, x, y);
+    printf("%s x:%d y:%d\n", occupied ? "occupied" : "cleared", x, y);
+    irobot_mark(w, here, x, y, occupied);
+    return 1;
+}
+
 search_cell_t* irobot_move(uart_t *uart, ssd1306_t *oled, search_map_t *map,
-        search_cell_t *start, search_cell_t *goal, int timeout_s)
+        search_dstar_t *dstar, search_cspace_t *cspace,
+        search_occupancy_t *occupancy, search_bits_t *visited,
+        search_path_t *path, search_cell_t *goal, int timeout_s)
 {
-    const s16 unit_distance_mm = 24*8; // ~8 inches
+    const s16 unit_distance_mm = irobot_unit_mm;
+
+    // The incremental planner is primed on the first replan of the move.
+    irobot_world_t world = {
+        .oled = oled,
+        .map = map,
+        .dstar = dstar,
+        .dstar_primed = 0,
+        .cspace = cspace,
+        .occupancy = occupancy,
+        .goal = goal,
+    };
 
     // Sample the time, used to track elapsed time.
     XTime time_start;
@@ -233,75 +315,149 @@ search_cell_t* irobot_move(uart_t *uart, ssd1306_t *oled, search_map_t *map,
     direction_t direction_current = direction_forward;
 
     // Mark our starting position on the map.
-    ssd1306_display_square(oled, start->x*8, start->y*8, ssd1306_square_stipple);
-
-    // Walk through the path, calculating movement with each cell.
-    search_cell_t *c;
-    for (c = start->next; c; c = c->next) {
-
-        // Have we timed out? If so, move back one cell (we never did actually
-        // move), and bail..
+    int x = path->start_x;
+    int y = path->start_y;
+    ssd1306_display_square(oled, x*8, y*8, ssd1306_square_stipple);
+
+    // Walk through the path a straight run at a time, so each run is a single
+    // drive rather than a stop at every cell. Runs are kept short enough that
+    // the drive distance fits in an s16.
+    const int max_cells = irobot_run_cells;
+    u8 wall[irobot_run_cells+1];
+    int i = 0;
+    while (i < path->length) {
+
+        // Have we timed out? If so, we're still on the last cell we reached,
+        // so bail..
+        int budget = max_cells;
         if (timeout_s) {
             XTime time_now;
             XTime_GetTime(&time_now);
             const int elapsed_s = (time_now - time_start)/COUNTS_PER_SECOND;
             if (elapsed_s > timeout_s) {
-                c = c->prev;
-                printf("timeout x:%d y:%d\n", c->x, c->y);
+                printf("timeout x:%d y:%d\n", x, y);
                 break;
             }
-        }
 
-        // Calculate the delta, and ignore vacuous moves.
-        const int dx = c->x - c->prev->x;
-        const int dy = c->y - c->prev->y;
-        if (!dx && !dy) {
-            continue;
+            // Don't start a run that would carry on long past the timeout.
+            const int cells_left =
+                (((timeout_s - elapsed_s)*1000)/irobot_cell_ms) + 1;
+            if (cells_left < budget) {
+                budget = cells_left;
+            }
         }
-        printf("x:%d y:%d dx:%d dy:%d\n", c->x, c->y, dx, dy);
 
-        // Calculate the direction and rotate.
-        direction_t direction_next = direction_from_delta(dx,dy);
+        // Moves share the direction encoding, so there's nothing to convert.
+        const int move = search_path_move(path, i);
+        const int cells = search_path_run(path, i, budget);
+        printf("x:%d y:%d move:%d cells:%d\n", x, y, move, cells);
+
+        // Rotate to face along the run.
+        direction_t direction_next = (direction_t)move;
         irobot_rotate(uart, direction_current, direction_next);
         direction_current = direction_next;
 
-        // Travel a unit distance.
-        const int distance_mm =
-            irobot_drive_straight_sense(uart,unit_distance_mm);
+        // Travel the run in one go.
+        int k;
+        for (k = 0; k <= cells; ++k) {
+            wall[k] = 0;
+        }
+        const int distance_mm = irobot_drive_straight_sense(uart,
+                cells*unit_distance_mm, unit_distance_mm, wall);
         printf("drove %d mm\n", distance_mm);
 
-        // If we didn't travel the full length, we've hit something.
-        // Figure out where the obstacle is, and route around.
-        if (distance_mm < unit_distance_mm/2) {
+        // A cell is reached once we're more than halfway into it. Update our
+        // position on the map for each one. Each cell we reach is free, and
+        // the wall sensor reports on the cell to our right as we pass, from
+        // the cell we started on. Any change in what's occupied means the
+        // path needs another look.
+        int reached = (distance_mm + (unit_distance_mm/2))/unit_distance_mm;
+        if (reached > cells) {
+            reached = cells;
+        }
+        int replan = 0;
+        const int right = (move+1)&3;
+        for (k = 0; k <= reached; ++k) {
+            if (k) {
+                ssd1306_display_square(oled, x*8, y*8, ssd1306_square_blank);
+                search_path_step(move, &x, &y);
+                ssd1306_display_square(oled, x*8, y*8, ssd1306_square_stipple);
+            }
+            search_cell_t *here = search_cell_at(map, x, y);
+            if (visited) {
+                search_bits_set(visited, x, y, 1);
+            }
+            replan |= irobot_observe(&world, here, x, y, irobot_odds_traversed);
+            int side_x = x, side_y = y;
+            search_path_step(right, &side_x, &side_y);
+            replan |= irobot_observe(&world, here, side_x, side_y,
+                    wall[k] ? irobot_odds_wall : irobot_odds_wall_clear);
+        }
 
-            // Mark and draw the obstacle.
-            printf("obstacle found near x:%d y:%d\n", c->x, c->y);
-            c->blocked = 1;
-            ssd1306_display_square(oled, c->x*8, c->y*8, ssd1306_square_solid);
+        // If we didn't reach the end of the run, we've hit something in the
+        // next cell. Figure out where the obstacle is, and route around.
+        if (reached < cells) {
+            int next_x = x, next_y = y;
+            search_path_step(move, &next_x, &next_y);
+            search_cell_t *here = search_cell_at(map, x, y);
+            printf("obstacle found near x:%d y:%d\n", next_x, next_y);
+
+            // A bump blocks the cell whatever the earlier evidence said, or
+            // we'd plan straight back into it. What decays is the evidence.
+            if (occupancy) {
+                int odds = irobot_odds_bump;
+                const int c = next_x + (occupancy->dim_x*next_y);
+                if ((occupancy->odds[c] + odds) < occupancy->occupied_odds) {
+                    odds = occupancy->occupied_odds - occupancy->odds[c];
+                }
+                irobot_observe(&world, here, next_x, next_y, odds);
+            } else {
+                irobot_mark(&world, here, next_x, next_y, 1);
+            }
 
-            printf("backing up %d mm\n", distance_mm);
-            irobot_drive_straight(uart, -distance_mm);
+            // Back up to the middle of the last cell reached.
+            const int backup_mm = distance_mm - (reached*unit_distance_mm);
+            if (backup_mm > 0) {
+                printf("backing up %d mm\n", backup_mm);
+                irobot_drive_straight(uart, -backup_mm);
+            }
+            replan = 1;
+        }
+        if (!replan) {
+            i += cells;
+            continue;
+        }
 
-            // Pathfind around the obstacle.
-            c = c->prev;
-            printf("find %d,%d->%d,%d\n", c->x,c->y,goal->x,goal->y);
-            search_map_initialize(map,0);
-            search_find(map, c, goal);
-            if (!goal->closed) {
-                printf("panic: could not route around obstacle!\n");
-                break;
+        // Pathfind around the change into the path, and follow it from its
+        // first move.
+        // The first replan costs a full search either way, but once the
+        // planner is primed, later ones only repair what changed.
+        search_cell_t *c = search_cell_at(map, x, y);
+        printf("find %d,%d->%d,%d\n", c->x,c->y,goal->x,goal->y);
+        int found;
+        if (dstar) {
+            if (!world.dstar_primed) {
+                search_dstar_initialize(dstar, c, direction_current, goal,
+                        search_heading_forward);
+                world.dstar_primed = 1;
             }
+            found = !search_dstar_find(dstar, c, direction_current) &&
+                !search_path_copy(path, c);
         } else {
-
-            // The move was successful, update our position on the map.
-            ssd1306_display_square(oled, c->prev->x*8, c->prev->y*8, ssd1306_square_blank);
-            ssd1306_display_square(oled, c->x*8, c->y*8, ssd1306_square_stipple);
+            search_map_initialize(map,0);
+            found = !search_find_path(map, c, goal, search_mode_astar,
+                    path);
+        }
+        if (!found) {
+            printf("panic: could not route around obstacle!\n");
+            break;
         }
+        i = 0;
     }
 
     // Finally, reorient to starting stance.
     irobot_rotate(uart, direction_current, direction_forward);
-    return c;
+    return search_cell_at(map, x, y);
 }
 
 void irobot_play_song(uart_t *uart, u8 song)
@@ -4,6 +4,10 @@
 #define _irobot_h_
 
 #include "search.h"
+#include "search_dstar.h"
+#include "search_path.h"
+#include "search_cspace.h"
+#include "search_occupancy.h"
 #include "ssd1306.h"
 #include "uart.h"
 
@@ -18,12 +22,41 @@ void irobot_read_sensor(uart_t *uart, irobot_sensor_t *s);
 // Move in a straight line.
 void irobot_drive_straight(uart_t *uart, s16 distance_mm);
 void irobot_drive_straight_rate(uart_t *uart, s16 rate);
-int irobot_drive_straight_sense(uart_t *uart, s16 distance_mm);
+// If wall is set, wall[i] is set if the wall sensor saw something while the
+// robot was nearest the i-th cell_mm mark along the way, the 0th being where
+// it started; the caller clears the distance_mm/cell_mm+1 entries.
+int irobot_drive_straight_sense(uart_t *uart, s16 distance_mm, s16 cell_mm,
+        u8 *wall);
 
 // In place rotation.
+// Each 90 degree turn waits out irobot_turn_ms.
 void irobot_rotate_left(uart_t *uart);
 void irobot_rotate_right(uart_t *uart);
 
+// The time each maneuver takes: a 90 degree turn, and driving one ~192mm cell
+// at 100mm/s. Planners that minimize drive time use these as their costs.
+#define irobot_turn_ms 1000
+#define irobot_cell_ms 1920
+
+// The robot is ~33cm across, and doesn't fit through a one cell (~19cm) gap,
+// so obstacles are inflated by a cell.
+#define irobot_clearance_cells 1
+
+// The sensor model for the occupancy grid, as log-odds in 1/32 nats. One
+// bump makes a cell occupied, but it takes two wall readings, since the wall
+// sensor is the noisier of the two. Driving through a cell all but proves
+// it's free.
+#define irobot_odds_bump 48
+#define irobot_odds_wall 24
+#define irobot_odds_wall_clear (-12)
+#define irobot_odds_traversed (-64)
+#define irobot_odds_occupied 32
+#define irobot_odds_free 16
+
+// Between runs, evidence decays by a quarter, so a lone bump is forgotten
+// after a few runs unless it's seen again.
+#define irobot_odds_decay_shift 2
+
 // Please don't change these values. The direction_rotate function explicitly
 // relies on the supplied encoding.
 typedef enum {
@@ -44,11 +77,25 @@ int direction_from_delta(int dx, int dy);
 // direction from the current direction.
 void direction_rotation(int current, int next, char *rotation, int *count);
 
-// Move along the from start to goal, assuming the path is well defined.
+// Move along the path to goal, assuming the path is well defined. Each
+// straight run of the path is driven as a single segment.
 // Stop movement if time runs out -- return the final location of the robot.
 // A timeout_s value of 0 will *never* timeout.
+// If dstar is set, obstacles are routed around incrementally with the D* Lite
+// planner, from the robot's current heading and counting turns at the costs
+// it was allocated with; otherwise each obstacle triggers a full search that
+// ignores turns. Either way the new route is written over the path.
+// If cspace is set, obstacles are reported to it, so they're inflated by the
+// robot's footprint, sparing the robot's cell and the goal.
+// If occupancy is set, bumps, wall readings and the cells driven through are
+// added to it as evidence, and cells are blocked and unblocked as its
+// threshold view changes; otherwise every bump blocks a cell for good.
+// If visited is set, every cell the robot reaches is set in it, whether or
+// not it was on the path as first planned.
 search_cell_t* irobot_move(uart_t *uart, ssd1306_t *oled, search_map_t *map,
-        search_cell_t *start, search_cell_t *goal, int timeout_s);
+        search_dstar_t *dstar, search_cspace_t *cspace,
+        search_occupancy_t *occupancy, search_bits_t *visited,
+        search_path_t *path, search_cell_t *goal, int timeout_s);
 
 // Play the specified song. Hopefully it's programmed :)
 void irobot_play_song(uart_t *uart, u8 song);
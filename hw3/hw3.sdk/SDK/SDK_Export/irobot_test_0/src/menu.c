@@ -8,6 +8,7 @@
 fn_programmed_route menu_handler_programmed_route = 0;
 fn_user_route menu_handler_user_route = 0;
 fn_search menu_handler_search = 0;
+fn_sweep menu_handler_sweep = 0;
 
 // Run the menu, invoking any registered handlers as necessary.
 void menu_run(gpio_axi_t *gpio, ssd1306_t *oled, void *context)
@@ -45,6 +46,16 @@ void menu_run(gpio_axi_t *gpio, ssd1306_t *oled, void *context)
                 break;
              }
 
+            case menu_id_sweep: {
+                int t;
+                menu_input_time(gpio, oled, &t);
+                strcpy(task, "Area Sweep");
+                if (menu_handler_sweep) {
+                    menu_handler_sweep(t,context);
+                }
+                break;
+             }
+
             case menu_id_quit: {
                 ssd1306_clear(oled);
                 ssd1306_display_string(oled, "Quitting the program");
@@ -70,6 +81,8 @@ u8 menu_main(gpio_axi_t *gpio, ssd1306_t *oled)
     ssd1306_clear_line(oled, 2);
     ssd1306_display_string(oled, "  Search");
     ssd1306_clear_line(oled, 3);
+    ssd1306_display_string(oled, "  Sweep");
+    ssd1306_clear_line(oled, 4);
     ssd1306_display_string(oled, "  Quit");
 
     u32 selection = 0;
@@ -80,7 +93,7 @@ u8 menu_main(gpio_axi_t *gpio, ssd1306_t *oled)
         if (selection == button_down){
             ssd1306_set_page_start(oled, page);
             ssd1306_display_string(oled, "  ");
-            if (page == 3) {
+            if (page == menu_id_quit) {
                 page = 0;
             } else {
                 page++;
@@ -93,7 +106,7 @@ u8 menu_main(gpio_axi_t *gpio, ssd1306_t *oled)
             ssd1306_set_page_start(oled, page);
             ssd1306_display_string(oled, "  ");
             if (page == 0) {
-                page = 3;
+                page = menu_id_quit;
             } else {
                 page--;
             }
@@ -10,17 +10,20 @@ enum menu_id_t {
     menu_id_programmed_route = 0,
     menu_id_user_route       = 1,
     menu_id_search           = 2,
-    menu_id_quit             = 3,
+    menu_id_sweep            = 3,
+    menu_id_quit             = 4,
 };
 
 typedef void (*fn_programmed_route)(void *context);
 typedef void (*fn_user_route)(int *coords, int count, void *context);
 typedef void (*fn_search)(int time_s, void *context);
+typedef void (*fn_sweep)(int time_s, void *context);
 
 // Handlers that will fire if set when using menu_run.
 extern fn_programmed_route menu_handler_programmed_route;
 extern fn_user_route menu_handler_user_route;
 extern fn_search menu_handler_search;
+extern fn_sweep menu_handler_sweep;
 
 // Run the menuing system.
 void menu_run(gpio_axi_t *gpio, ssd1306_t *oled, void *context);
@@ -2,21 +2,16 @@
 // Tristan Monroe <twmonroe@eng.ucsd.edu>
 #include <iostream>
 #include <algorithm>
-#include <set>
-#include <iterator>
+#include <cstdlib>
 #include <limits>
 
 extern "C" {
 #include "search.h"
+#include "search_path.h"
+#include "search_context.h"
 }
-
-// Provide ordering for the open set.
-// This will cause the open set to return the cell with the smallest f first.
-struct order_cell_by_f {
-    bool operator()(const search_cell_t *lhs, const search_cell_t *rhs) const {
-        return lhs->f < rhs->f;
-    }
-};
+#include "search_grid.h"
+#include "search_heap.h"
 
 std::ostream& operator<<(std::ostream &os, const search_cell_t *c)
 {
@@ -35,6 +30,172 @@ static int h_distance(search_cell_t *start, search_cell_t *goal)
     return std::abs(start->x-goal->x) + std::abs(start->y-goal->y);
 }
 
+#ifndef SEARCH_OPEN_BUCKET
+
+// The open list is a binary min-heap of cells.
+
+// Provide ordering for the open list.
+// This will cause the open list to return the cell with the smallest f first.
+// Ties are broken on the smallest h, which favors cells closer to the goal.
+static bool cell_less(const search_cell_t *lhs, const search_cell_t *rhs)
+{
+    if (lhs->f != rhs->f) {
+        return lhs->f < rhs->f;
+    }
+    return lhs->h < rhs->h;
+}
+
+namespace {
+
+// The open list's order and positions, for search_heap.h.
+struct open_heap_ops {
+    bool less(const search_cell_t *lhs, const search_cell_t *rhs) const
+    {
+        return cell_less(lhs, rhs);
+    }
+
+    int index(const search_cell_t *c) const
+    {
+        return c->open_index;
+    }
+
+    void place(search_cell_t *c, int i) const
+    {
+        c->open_index = i;
+    }
+};
+
+}
+
+// The heap needs one slot per cell.
+static int open_size(int dim_x, int dim_y)
+{
+    return dim_x*dim_y;
+}
+
+// Empty the open list.
+static void open_clear(search_map_t *map)
+{
+    map->open_count = 0;
+}
+
+// Place a cell on the open list.
+static void open_push(search_map_t *map, search_cell_t *c)
+{
+    c->open = true;
+    search_heap_push(map->open, &map->open_count, c, open_heap_ops());
+}
+
+// Remove and return the best cell on the open list.
+static search_cell_t* open_pop(search_map_t *map)
+{
+    search_cell_t *c = search_heap_pop(map->open, &map->open_count,
+            open_heap_ops());
+    c->open = false;
+    return c;
+}
+
+// Restore heap order after an open cell's f was lowered in place.
+static void open_decrease(search_map_t *map, search_cell_t *c)
+{
+    search_heap_decrease(map->open, &map->open_count, c, open_heap_ops());
+}
+
+#else
+
+// The open list is an array of intrusive lists, one per f value. Cells are
+// pushed to the front of their bucket, so ties on f favor the most recently
+// discovered cell. open_min tracks the lowest bucket that may be occupied.
+
+// Unlink a cell from its bucket.
+static void bucket_unlink(search_map_t *map, search_cell_t *c)
+{
+    if (c->open_prev) {
+        c->open_prev->open_next = c->open_next;
+    } else {
+        map->open[c->open_index] = c->open_next;
+    }
+    if (c->open_next) {
+        c->open_next->open_prev = c->open_prev;
+    }
+}
+
+// Link a cell at the front of the bucket for its f.
+static void bucket_link(search_map_t *map, search_cell_t *c)
+{
+    const int f = c->f;
+    c->open_index = f;
+    c->open_prev = 0;
+    c->open_next = map->open[f];
+    if (c->open_next) {
+        c->open_next->open_prev = c;
+    }
+    map->open[f] = c;
+    if (f < map->open_min) {
+        map->open_min = f;
+    }
+}
+
+// f = g + h is bounded by the longest possible path plus the largest
+// Manhattan distance.
+static int open_size(int dim_x, int dim_y)
+{
+    return (dim_x*dim_y) + dim_x + dim_y;
+}
+
+// Empty the open list. Only the buckets still holding cells are visited, so
+// this costs no more than the search that filled them.
+static void open_clear(search_map_t *map)
+{
+    for (int i = map->open_min; map->open_count && (i < map->open_size); ++i) {
+        for (search_cell_t *c = map->open[i]; c; c = c->open_next) {
+            --map->open_count;
+        }
+        map->open[i] = 0;
+    }
+    map->open_count = 0;
+    map->open_min = map->open_size;
+}
+
+// Place a cell on the open list.
+static void open_push(search_map_t *map, search_cell_t *c)
+{
+    c->open = true;
+    bucket_link(map, c);
+    ++map->open_count;
+}
+
+// Remove and return the best cell on the open list.
+static search_cell_t* open_pop(search_map_t *map)
+{
+    while (!map->open[map->open_min]) {
+        ++map->open_min;
+    }
+    search_cell_t *c = map->open[map->open_min];
+    bucket_unlink(map, c);
+    --map->open_count;
+    c->open = false;
+    return c;
+}
+
+// Move an open cell to the bucket for its lowered f.
+static void open_decrease(search_map_t *map, search_cell_t *c)
+{
+    bucket_unlink(map, c);
+    bucket_link(map, c);
+}
+
+#endif
+
+// The planner specialised for the arena.
+typedef search_grid_planner<search_arena_dim_x, search_arena_dim_y>
+    search_grid_arena_t;
+
+static search_grid_arena_t* arena_grid(search_map_t *map)
+{
+    return (search_grid_arena_t*)map->grid;
+}
+
 int search_map_alloc(search_map_t *map, int dim_x, int dim_y)
 {
     map->cells = (search_cell_t*)malloc(sizeof(search_cell_t)*dim_x*dim_y);
@@ -42,8 +203,45 @@ int search_map_alloc(search_map_t *map, int dim_x, int dim_y)
         std::cout << "malloc failed" << std::endl;
         return 1;
     }
+    map->open_size = open_size(dim_x, dim_y);
+    map->open = (search_cell_t**)calloc(map->open_size, sizeof(search_cell_t*));
+    if (!map->open) {
+        std::cout << "malloc failed" << std::endl;
+        free(map->cells);
+        map->cells = 0;
+        return 1;
+    }
+    if (search_bits_alloc(&map->bits, dim_x, dim_y)) {
+        free(map->cells);
+        free(map->open);
+        map->cells = 0;
+        map->open = 0;
+        return 1;
+    }
+    map->grid = 0;
+    map->stats = 0;
+#ifndef SEARCH_NO_GRID
+    if ((dim_x == search_arena_dim_x) && (dim_y == search_arena_dim_y)) {
+        map->grid = malloc(sizeof(search_grid_arena_t));
+        if (!map->grid) {
+            std::cout << "malloc failed" << std::endl;
+            search_bits_free(&map->bits);
+            free(map->cells);
+            free(map->open);
+            map->cells = 0;
+            map->open = 0;
+            return 1;
+        }
+    }
+#endif
+    map->open_count = 0;
+    map->open_min = map->open_size;
     map->dim_x = dim_x;
     map->dim_y = dim_y;
+
+    // Start every cell out unblocked.
+    map->generation = 0;
+    search_map_initialize(map, 1);
     return 0;
 }
 
@@ -53,24 +251,65 @@ void search_map_free(search_map_t *map)
         free(map->cells);
         map->cells = 0;
     }
+    if (map->open) {
+        free(map->open);
+        map->open = 0;
+    }
+    if (map->grid) {
+        free(map->grid);
+        map->grid = 0;
+    }
+    search_bits_free(&map->bits);
+    map->open_size = 0;
+    map->open_count = 0;
     map->dim_x = 0;
     map->dim_y = 0;
 }
 
+// Reset the search state of a cell to defaults.
+static void cell_reset(search_map_t *map, search_cell_t *c)
+{
+    c->g = std::numeric_limits<int>::max();
+    c->h = std::numeric_limits<int>::max();
+    c->prev = 0;
+    c->next = 0;
+    c->open = false;
+    c->closed = false;
+    c->open_index = -1;
+    c->generation = map->generation;
+}
+
+// Reset the search state of a cell if it's left over from an older
+// generation.
+static void cell_touch(search_map_t *map, search_cell_t *c)
+{
+    if (c->generation != map->generation) {
+        cell_reset(map, c);
+    }
+}
+
 // Initialize the map.
 void search_map_initialize(search_map_t *map, int clear_blocked)
 {
+    open_clear(map);
+
+    // Bump the generation so every cell is stale. When the counter wraps,
+    // a stale cell could look current again, so fall back to a full reset.
+    if (++map->generation && !clear_blocked) {
+        return;
+    }
+    if (clear_blocked) {
+        search_bits_clear(&map->bits);
+        if (map->grid) {
+            arena_grid(map)->clear();
+        }
+    }
     for (int i = 0; i < map->dim_x; ++i) {
         for (int j = 0; j < map->dim_y; ++j) {
             search_cell_t *current = search_cell_at(map,i,j);
             current->x = i;
             current->y = j;
-            current->g = std::numeric_limits<int>::max();
-            current->h = std::numeric_limits<int>::max();
-            current->prev = 0;
-            current->next = 0;
-            current->open = false;
-            current->closed = false;
+            cell_reset(map, current);
             if (clear_blocked) {
                 current->blocked = false;
             }
@@ -78,67 +317,285 @@ void search_map_initialize(search_map_t *map, int clear_blocked)
     }
 }
 
+void search_map_set_blocked(search_map_t *map, search_cell_t *c, int blocked)
+{
+    c->blocked = blocked;
+    search_bits_set(&map->bits, c->x, c->y, blocked);
+    if (map->grid) {
+        arena_grid(map)->set_blocked(c->x, c->y, blocked);
+    }
+}
+
+// Consider reaching adj from current over a straight run of the given length.
+// If adj is already open, check if the path through current is better, and if
+// so, use the path through current. Otherwise, use the path through current
+// and place adj on the open list.
+static void relax(search_map_t *map, search_cell_t *current, search_cell_t *adj,
+        int length, search_cell_t *goal)
+{
+    const int g = current->g + length;
+    if (adj->open) {
+        if (g < adj->g) {
+            adj->prev = current;
+            adj->g = g;
+            adj->f = adj->g + adj->h;
+            open_decrease(map, adj);
+            search_stats_decrease(map->stats);
+        }
+        return;
+    }
+
+    // No shortest path is longer than the map has cells, so anything with a
+    // larger f can't be on one. This also keeps f within the open list.
+    const int h = h_distance(adj,goal);
+    if ((g + h) >= map->open_size) {
+        return;
+    }
+    adj->prev = current;
+    adj->g = g;
+    adj->h = h;
+    adj->f = adj->g + adj->h;
+    open_push(map, adj);
+    search_stats_push(map->stats, map->open_count);
+}
+
+static const int moves[][2] = {{-1,0},{1,0},{0,-1},{0,1}};
+
+// Expand every passable neighbor of current.
+static void expand_astar(search_map_t *map, search_cell_t *current,
+        search_cell_t *goal)
+{
+    // Check all adjacent cells.
+    // Ignore cells that are closed or unpassable. The bitboard reports cells
+    // off the map as blocked, in the same order as moves.
+    const int blocked = search_bits_neighbors(&map->bits, current->x, current->y);
+    for (unsigned i = 0; i < sizeof(moves)/sizeof(*moves); ++i) {
+        if (blocked & (1 << i)) {
+            continue;
+        }
+        search_cell_t *adj = search_cell_at(map,
+                current->x + moves[i][0], current->y + moves[i][1]);
+        cell_touch(map, adj);
+        if (adj->closed) {
+            continue;
+        }
+        relax(map, current, adj, 1, goal);
+    }
+}
+
+// Jump point search helpers. On a 4-connected grid, paths are kept canonical
+// by letting vertical runs turn horizontal anywhere, while horizontal runs
+// only turn where an obstacle forces them to. Only the cells where a path
+// may turn, the jump points, go on the open list.
+
+// Return non-zero if x,y is on the map and unblocked.
+static int passable(search_map_t *map, int x, int y)
+{
+    return !search_bits_test(&map->bits, x, y);
+}
+
+// Run horizontally from x,y in direction dx. Return the jump point, or 0 if
+// the run hits an obstacle or the edge of the map first.
+// A neighbor above or below is forced if the cell behind it is blocked,
+// since no vertical run could have reached it sooner. The bitboard finds
+// the first forced neighbor or obstacle a word at a time.
+static search_cell_t* jump_horizontal(search_map_t *map, int x, int y, int dx,
+        search_cell_t *goal)
+{
+    int blocked;
+    const int stop = search_bits_run(&map->bits, x, y, dx, &blocked);
+
+    // The goal may lie on the run before it stops.
+    if ((goal->y == y) && (((goal->x - x)*dx) > 0)) {
+        const int remaining = (stop - goal->x)*dx;
+        if ((remaining > 0) || (!remaining && !blocked)) {
+            return goal;
+        }
+    }
+    if (blocked) {
+        return 0;
+    }
+    return search_cell_at(map,stop,y);
+}
+
+// Run vertically from x,y in direction dy. Any cell a horizontal run can
+// leave toward a jump point is itself a jump point.
+static search_cell_t* jump_vertical(search_map_t *map, int x, int y, int dy,
+        search_cell_t *goal)
+{
+    for (;;) {
+        y += dy;
+        if (!passable(map,x,y)) {
+            return 0;
+        }
+        search_cell_t *c = search_cell_at(map,x,y);
+        if (c == goal) {
+            return c;
+        }
+        if ((passable(map,x-1,y) && !passable(map,x-1,y-dy)) ||
+                (passable(map,x+1,y) && !passable(map,x+1,y-dy))) {
+            return c;
+        }
+        if (jump_horizontal(map,x,y,-1,goal) || jump_horizontal(map,x,y,1,goal)) {
+            return c;
+        }
+    }
+}
+
+// Expand the jump points reachable from current. A cell reached horizontally
+// keeps going the same way or turns vertical; a cell reached vertically keeps
+// going the same way or turns horizontal. The start may go anywhere.
+static void expand_jps(search_map_t *map, search_cell_t *current,
+        search_cell_t *goal)
+{
+    int dx = 0, dy = 0;
+    if (current->prev) {
+        dx = (current->x > current->prev->x) - (current->x < current->prev->x);
+        dy = (current->y > current->prev->y) - (current->y < current->prev->y);
+    }
+
+    for (unsigned i = 0; i < sizeof(moves)/sizeof(*moves); ++i) {
+        const int mx = moves[i][0];
+        const int my = moves[i][1];
+
+        // Never turn back the way we came.
+        if ((mx && (mx == -dx)) || (my && (my == -dy))) {
+            continue;
+        }
+
+        search_cell_t *jump = mx ?
+            jump_horizontal(map, current->x, current->y, mx, goal) :
+            jump_vertical(map, current->x, current->y, my, goal);
+        if (!jump) {
+            continue;
+        }
+        cell_touch(map, jump);
+        if (jump->closed) {
+            continue;
+        }
+        const int length = std::abs(jump->x-current->x) + std::abs(jump->y-current->y);
+        relax(map, current, jump, length, goal);
+    }
+}
+
+// Fill in the cells skipped between jump points on the path to the goal, so
+// prev links step one cell at a time like an A* path.
+static void fill_jumps(search_map_t *map, search_cell_t *goal)
+{
+    for (search_cell_t *c = goal; c->prev; ) {
+        search_cell_t *jump = c->prev;
+        const int dx = (jump->x > c->x) - (jump->x < c->x);
+        const int dy = (jump->y > c->y) - (jump->y < c->y);
+        while ((c->x + dx != jump->x) || (c->y + dy != jump->y)) {
+            search_cell_t *between = search_cell_at(map, c->x + dx, c->y + dy);
+            cell_touch(map, between);
+            between->g = c->g - 1;
+            c->prev = between;
+            c = between;
+        }
+        c->prev = jump;
+        c = jump;
+    }
+}
+
 void search_find(search_map_t *map, search_cell_t *start, search_cell_t *goal)
+{
+    search_find_mode(map, start, goal, search_mode_astar);
+}
+
+// Search with the arena's planner, then copy the path back into the map's
+// cells as search_run would have left it.
+static void search_run_grid(search_map_t *map, search_cell_t *start,
+        search_cell_t *goal)
+{
+    search_grid_arena_t *grid = arena_grid(map);
+    cell_touch(map, start);
+    cell_touch(map, goal);
+    const int s = search_grid_arena_t::index(start->x, start->y);
+    const int t = search_grid_arena_t::index(goal->x, goal->y);
+    const int length = grid->find(s, t);
+    search_stats_t *stats = map->stats;
+    if (stats) {
+        stats->last.expanded = grid->expanded;
+        stats->last.pushes = grid->pushes;
+        stats->last.pops = grid->expanded;
+        stats->last.decreases = grid->decreases;
+        stats->last.open_peak = grid->open_peak;
+    }
+    if (length < 0) {
+        return;
+    }
+    search_cell_t *c = goal;
+    for (int i = t; i >= 0; i = grid->cell[i].parent) {
+        const int p = grid->cell[i].parent;
+        cell_touch(map, c);
+        c->g = grid->cell[i].g;
+        c->closed = true;
+        c->prev = (p < 0) ? 0 : search_cell_at(map,
+                search_grid_arena_t::x_of(p), search_grid_arena_t::y_of(p));
+        c = c->prev;
+    }
+}
+
+// Search with the map's cells and open list.
+static void search_run_map(search_map_t *map, search_cell_t *start,
+        search_cell_t *goal, search_mode_t mode)
 {
     // put the starting point on the open list.
-    typedef std::set<search_cell_t*,order_cell_by_f> open_t;
-    open_t open;
+    // The goal is touched up front so its state is current even if it's
+    // never reached.
+    open_clear(map);
+    cell_touch(map, start);
+    cell_touch(map, goal);
     start->g = 0;
     start->h = h_distance(start,goal);
     start->f = start->g + start->h;
-    start->open = true;
-    open.insert(start);
-
-    std::cout << "start: " << start << std::endl
-              << "goal: " << goal
-              << std::endl;
-
-    const int dim_x = map->dim_x;
-    const int dim_y = map->dim_y;
+    open_push(map, start);
+    search_stats_push(map->stats, map->open_count);
 
     // While there are still nodes to process ...
-    while (!open.empty() && !goal->closed) {
+    while (map->open_count && !goal->closed) {
 
         // Process the next open.
-        open_t::iterator i(open.begin());
-        search_cell_t *current = *i;
-        current->open = false;
+        search_cell_t *current = open_pop(map);
+        search_stats_pop(map->stats);
+        search_stats_expand(map->stats, 1);
         current->closed = true;
-        open.erase(i);
- 
-        // Check all adjacent cells.
-        // Ignore cells that are closed or unpassable.
-        static const int p[][2] = {{-1,0},{1,0},{0,-1},{0,1}};
-        for (unsigned i = 0; i < sizeof(p)/sizeof(*p); ++i) {
-            const int x = current->x + p[i][0];
-            const int y = current->y + p[i][1];
-            if ((x < 0) || (y < 0) || (x >= dim_x) || (y >= dim_y)) {
-                continue;
-            }
-            search_cell_t *adj = search_cell_at(map,x,y);
-            if (adj->blocked || adj->closed) {
-                continue;
-            }
-
-            // If adj is already open, check if the path through current is
-            // better, and if so, use the path through current. Otherwise, use
-            // the path through current and place adj on the open list.
-            if (adj->open && ((current->g+1) < adj->g)) {
-                adj->prev = current;
-                adj->g = current->g + 1;
-                adj->h = h_distance(adj,goal);
-                adj->f = adj->g + adj->h;
-            } else {
-                adj->prev = current;
-                adj->g = current->g + 1;
-                adj->h = h_distance(adj,goal);
-                adj->f = adj->g + adj->h;
-                adj->open = true;
-                open.insert(adj);
-            }
+        if (mode == search_mode_jps) {
+            expand_jps(map, current, goal);
+        } else {
+            expand_astar(map, current, goal);
         }
     }
 
+    if (goal->closed && (mode == search_mode_jps)) {
+        fill_jumps(map, goal);
+    }
+}
+
+// Search from start until the goal is closed or the open list runs dry. If
+// the goal was found, its prev links lead back to the start one cell at a
+// time. No next fields are written.
+static void search_run(search_map_t *map, search_cell_t *start,
+        search_cell_t *goal, search_mode_t mode)
+{
+    search_stats_begin(map->stats);
+    if (map->grid && (mode == search_mode_astar)) {
+        search_run_grid(map, start, goal);
+    } else {
+        search_run_map(map, start, goal, mode);
+    }
+    search_stats_end(map->stats, goal->closed);
+}
+
+void search_find_mode(search_map_t *map, search_cell_t *start,
+        search_cell_t *goal, search_mode_t mode)
+{
+    std::cout << "start: " << start << std::endl
+              << "goal: " << goal
+              << std::endl;
+    search_run(map, start, goal, mode);
+
     // If the goal was found and a path exists, build a forward path for
     // convenience.
     if (goal->closed) {
@@ -150,3 +607,94 @@ void search_find(search_map_t *map, search_cell_t *start, search_cell_t *goal)
         }
     }
 }
+
+int search_find_path(search_map_t *map, search_cell_t *start,
+        search_cell_t *goal, search_mode_t mode, search_path_t *path)
+{
+    search_path_clear(path, start->x, start->y);
+    search_run(map, start, goal, mode);
+    if (!goal->closed) {
+        return 1;
+    }
+
+    // The prev links run backward, so count the moves, then fill them in
+    // from the last.
+    int length = 0;
+    const search_cell_t *c;
+    for (c = goal; c->prev; c = c->prev) {
+        ++length;
+    }
+    if (length > path->capacity) {
+        return 1;
+    }
+    path->length = length;
+    for (c = goal; c->prev; c = c->prev) {
+        search_path_set(path, --length,
+                search_path_direction(c->x - c->prev->x, c->y - c->prev->y));
+    }
+    return 0;
+}
+
+int search_context_alloc(search_context_t *context, search_map_t *map)
+{
+    search_map_t *scratch = &context->scratch;
+    const int dim_x = map->dim_x;
+    const int dim_y = map->dim_y;
+    context->map = map;
+    scratch->cells = (search_cell_t*)malloc(sizeof(search_cell_t)*dim_x*dim_y);
+    scratch->open_size = open_size(dim_x, dim_y);
+    scratch->open = (search_cell_t**)calloc(scratch->open_size,
+            sizeof(search_cell_t*));
+    if (!scratch->cells || !scratch->open) {
+        std::cout << "malloc failed" << std::endl;
+        search_context_free(context);
+        return 1;
+    }
+    scratch->open_count = 0;
+    scratch->open_min = scratch->open_size;
+    scratch->dim_x = dim_x;
+    scratch->dim_y = dim_y;
+
+    // Borrow the map's bitboard. The scratch cells' blocked fields aren't
+    // kept; searches only read the bitboard.
+    scratch->bits = map->bits;
+    scratch->generation = 0;
+
+    // The map's planner holds search state, so it can't be shared; contexts
+    // search generically.
+    scratch->grid = 0;
+    scratch->stats = 0;
+    for (int i = 0; i < dim_x; ++i) {
+        for (int j = 0; j < dim_y; ++j) {
+            search_cell_t *current = search_cell_at(scratch,i,j);
+            current->x = i;
+            current->y = j;
+            current->blocked = false;
+            cell_reset(scratch, current);
+        }
+    }
+    return 0;
+}
+
+int search_context_find(search_context_t *context, const search_cell_t *start,
+        const search_cell_t *goal, search_mode_t mode, search_path_t *path)
+{
+    search_map_t *map = context->map;
+    search_map_t *scratch = &context->scratch;
+    search_map_initialize(scratch, 0);
+    return search_find_path(scratch, &scratch->cells[start - map->cells],
+            &scratch->cells[goal - map->cells], mode, path);
+}
+
+void search_context_free(search_context_t *context)
+{
+    search_map_t *scratch = &context->scratch;
+    free(scratch->cells);
+    free(scratch->open);
+    scratch->cells = 0;
+    scratch->open = 0;
+    scratch->open_size = 0;
+    scratch->open_count = 0;
+    scratch->dim_x = 0;
+    scratch->dim_y = 0;
+}
@@ -3,6 +3,14 @@
 #ifndef _search_h_
 #define _search_h_
 
+#include "search_bits.h"
+#include "search_stats.h"
+
+// The arena's dimensions in cells. Maps this size are searched by a planner
+// specialised for it at compile time; see search_grid.h.
+#define search_arena_dim_x (128/8)
+#define search_arena_dim_y (64/8)
+
 // Information about cell needed to support search (A*).
 struct search_cell {
 
@@ -14,6 +22,8 @@ struct search_cell {
     struct search_cell *prev, *next;
 
     // this cell is on the open list.
+    // blocked mirrors the map's occupancy bitboard; change it with
+    // search_map_set_blocked so the two stay in step.
     int open, blocked, closed;
 
     // cost metrics.
@@ -21,6 +31,17 @@ struct search_cell {
     int h;
     int f;
 
+    // position of the cell in the open list: the heap slot, or the f bucket
+    // when built with SEARCH_OPEN_BUCKET. Only meaningful while open.
+    int open_index;
+
+    // bucket siblings, used only when built with SEARCH_OPEN_BUCKET.
+    struct search_cell *open_prev, *open_next;
+
+    // the map generation this cell's search state belongs to. Search state
+    // from an older generation is stale and is reset on first touch.
+    unsigned generation;
+
 };
 typedef struct search_cell search_cell_t;
 
@@ -28,6 +49,33 @@ typedef struct search_cell search_cell_t;
 struct search_map {
     int dim_x, dim_y;
     search_cell_t * cells;
+
+    // The open list. By default this is a binary min-heap ordered by (f,h)
+    // with room for every cell. When built with SEARCH_OPEN_BUCKET, this is
+    // instead an array of bucket heads indexed by f (Dial's algorithm), which
+    // works because every step costs 1 and h is integer Manhattan distance.
+    // Either way it's allocated up front so search_find never allocates.
+    search_cell_t ** open;
+    int open_size;
+    int open_count;
+    int open_min;
+
+    // The current search generation. Bumping this clears the search state of
+    // every cell at once.
+    unsigned generation;
+
+    // The blocked cells as a bitboard, which search_find scans a word at a
+    // time.
+    search_bits_t bits;
+
+    // The planner specialised for the arena, kept in step with the blocked
+    // cells, or null if the map isn't arena sized or this was built with
+    // SEARCH_NO_GRID.
+    void *grid;
+
+    // Where search_find counts the cost of each query, or null not to.
+    // search_map_alloc leaves this null.
+    search_stats_t *stats;
 };
 typedef struct search_map search_map_t;
 
@@ -39,15 +87,42 @@ int search_map_alloc(search_map_t *map, int dim_x, int dim_y);
 // to meaningful defaults. This should be called before using search_find. If
 // the clear blocked is not set, the blocked attribute on cells will remain.
 // This is useful for searching and obstacle detection.
+//
+// Without clear blocked this is O(1): the map generation is bumped and each
+// cell is reset when search_find first touches it. Only the cells reached by
+// the last search_find, including its start and goal, have meaningful search
+// state; the rest may hold state from an earlier search.
 void search_map_initialize(search_map_t *map, int clear_blocked);
 
 // Return a reference to the cell in the map at the specified location.
 search_cell_t *search_cell_at(search_map_t *map, int x, int y);
 
+// Set the blocked state of a cell.
+void search_map_set_blocked(search_map_t *map, search_cell_t *c, int blocked);
+
 // Find the goal given the map and start cell. The map must be initialized with
 // search_map_initialize before calling this function.
+//
+// On an arena sized map, A* runs on the specialised planner and only the
+// start, the goal and the cells of the path are left with search state.
 void search_find(search_map_t *map, search_cell_t *start, search_cell_t *goal);
 
+// The ways search_find_mode can search the map.
+typedef enum {
+    // A*, expanding every neighbor of every cell. This is what search_find
+    // does.
+    search_mode_astar = 0,
+
+    // Jump point search. Paths are as short as A* paths, but only cells where
+    // the path may turn are expanded, which is far fewer on open maps. The
+    // cells in between are filled in, so the path is threaded the same way.
+    search_mode_jps   = 1,
+} search_mode_t;
+
+// Like search_find, using the given search mode.
+void search_find_mode(search_map_t *map, search_cell_t *start,
+        search_cell_t *goal, search_mode_t mode);
+
 // Free any dynamic memory associated with the map.
 void search_map_free(search_map_t *map);
 #endif
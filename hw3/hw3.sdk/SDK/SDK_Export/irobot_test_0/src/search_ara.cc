@@ -0,0 +1,264 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#include <iostream>
+#include <cstdlib>
+#include <limits>
+
+extern "C" {
+#include "search_ara.h"
+}
+#include "search_heap.h"
+
+static const int infinity = std::numeric_limits<int>::max()/32;
+
+static const int moves[][2] = {{-1,0},{1,0},{0,-1},{0,1}};
+
+// The expansions between polls of the caller's clock. Every call gets at
+// least this many, so a spent clock can't stall the planner.
+static const int poll_interval = 64;
+
+static int h_distance(const search_ara_t *ara, int c)
+{
+    const int dim_x = ara->map->dim_x;
+    return std::abs((c%dim_x)-(ara->goal%dim_x))
+        + std::abs((c/dim_x)-(ara->goal/dim_x));
+}
+
+// Reset a cell's search state if it belongs to an older query.
+static void touch(search_ara_t *a, int c)
+{
+    if (a->generation[c] != a->query) {
+        a->generation[c] = a->query;
+        a->g[c] = infinity;
+        a->parent[c] = -1;
+        a->heap_index[c] = -1;
+    }
+}
+
+// The key of a cell in tenths: g + epsilon*h.
+static int key_of(const search_ara_t *ara, int c)
+{
+    return (10*ara->g[c]) + (ara->epsilon*h_distance(ara, c));
+}
+
+// Open list order. Ties on the key go to the cell that's furthest along.
+static bool key_less(const search_ara_t *a, int x, int y)
+{
+    if (a->key[x] != a->key[y]) {
+        return a->key[x] < a->key[y];
+    }
+    return a->g[x] > a->g[y];
+}
+
+namespace {
+
+// The open list's order and positions, for search_heap.h.
+struct ara_heap_ops {
+    search_ara_t *a;
+
+    bool less(int x, int y) const
+    {
+        return key_less(a, x, y);
+    }
+
+    int index(int c) const
+    {
+        return a->heap_index[c];
+    }
+
+    void place(int c, int i) const
+    {
+        a->heap_index[c] = i;
+    }
+};
+
+ara_heap_ops ops(search_ara_t *a)
+{
+    const ara_heap_ops o = { a };
+    return o;
+}
+
+}
+
+// Queue a cell at its key, or move it up if its key dropped.
+static void heap_push(search_ara_t *a, int c)
+{
+    a->key[c] = key_of(a, c);
+    search_heap_decrease(a->heap, &a->heap_count, c, ops(a));
+}
+
+// Start the next pass: lower epsilon, put the inconsistent cells back on
+// the open list, and rekey it for the new epsilon.
+static void next_pass(search_ara_t *a)
+{
+    a->epsilon = std::max(10, a->epsilon - a->epsilon_step);
+    for (int i = 0; i < a->incons_count; ++i) {
+        const int c = a->incons_list[i];
+        if (a->heap_index[c] < 0) {
+            a->heap[a->heap_count] = c;
+            a->heap_index[c] = a->heap_count++;
+        }
+    }
+    a->incons_count = 0;
+    ++a->pass;
+    for (int i = 0; i < a->heap_count; ++i) {
+        a->key[a->heap[i]] = key_of(a, a->heap[i]);
+    }
+    search_heap_build(a->heap, a->heap_count, ops(a));
+}
+
+// Clear every cell's state and restart the counters.
+static void reset(search_ara_t *a)
+{
+    const int cells = a->map->dim_x*a->map->dim_y;
+    for (int c = 0; c < cells; ++c) {
+        a->closed[c] = a->incons[c] = a->generation[c] = 0;
+    }
+    a->pass = a->query = 0;
+}
+
+int search_ara_alloc(search_ara_t *ara, search_map_t *map)
+{
+    const int cells = map->dim_x*map->dim_y;
+    ara->map = map;
+    ara->g = (int*)malloc(sizeof(int)*cells);
+    ara->parent = (int*)malloc(sizeof(int)*cells);
+    ara->heap = (int*)malloc(sizeof(int)*cells);
+    ara->heap_index = (int*)malloc(sizeof(int)*cells);
+    ara->key = (int*)malloc(sizeof(int)*cells);
+    ara->closed = (unsigned*)malloc(sizeof(unsigned)*cells);
+    ara->incons = (unsigned*)malloc(sizeof(unsigned)*cells);
+    ara->incons_list = (int*)malloc(sizeof(int)*cells);
+    ara->generation = (unsigned*)malloc(sizeof(unsigned)*cells);
+    ara->heap_count = ara->incons_count = 0;
+    ara->start = ara->goal = -1;
+    if (!ara->g || !ara->parent || !ara->heap || !ara->heap_index ||
+            !ara->key || !ara->closed || !ara->incons || !ara->incons_list ||
+            !ara->generation) {
+        std::cout << "malloc failed" << std::endl;
+        search_ara_free(ara);
+        return 1;
+    }
+    reset(ara);
+    return 0;
+}
+
+void search_ara_free(search_ara_t *ara)
+{
+    free(ara->g);
+    free(ara->parent);
+    free(ara->heap);
+    free(ara->heap_index);
+    free(ara->key);
+    free(ara->closed);
+    free(ara->incons);
+    free(ara->incons_list);
+    free(ara->generation);
+    ara->g = ara->parent = ara->heap = ara->heap_index = ara->key = 0;
+    ara->closed = ara->incons = ara->generation = 0;
+    ara->incons_list = 0;
+    ara->heap_count = ara->incons_count = 0;
+    ara->start = ara->goal = -1;
+}
+
+void search_ara_initialize(search_ara_t *ara, search_cell_t *start,
+        search_cell_t *goal, int epsilon, int epsilon_step)
+{
+    search_map_t *map = ara->map;
+
+    // Leave room for a query's worth of passes before the counters wrap.
+    if ((++ara->query == 0) || (ara->pass > (~0u - 1024))) {
+        reset(ara);
+        ara->query = 1;
+    }
+    ara->heap_count = ara->incons_count = 0;
+    ++ara->pass;
+    ara->epsilon = std::max(10, epsilon);
+    ara->epsilon_step = std::max(1, epsilon_step);
+    ara->bound = 0;
+    ara->start = start - map->cells;
+    ara->goal = goal - map->cells;
+    touch(ara, ara->start);
+    touch(ara, ara->goal);
+    ara->g[ara->start] = 0;
+    heap_push(ara, ara->start);
+}
+
+int search_ara_optimal(const search_ara_t *ara)
+{
+    return ara->bound == 10;
+}
+
+int search_ara_find(search_ara_t *ara, int max_expansions,
+        search_expired_t expired, void *context)
+{
+    search_map_t *map = ara->map;
+    int expansions = 0;
+    int spent = 0;
+    while (!spent && !search_ara_optimal(ara)) {
+
+        // Expand until the goal's key is no worse than anything open, or
+        // the budget runs out.
+        while (ara->heap_count &&
+                ((10*ara->g[ara->goal]) > ara->key[ara->heap[0]])) {
+            if ((max_expansions && (expansions >= max_expansions)) ||
+                    (expired && expansions && !(expansions % poll_interval) &&
+                     expired(context))) {
+                spent = 1;
+                break;
+            }
+            ++expansions;
+
+            const int c = search_heap_pop(ara->heap, &ara->heap_count,
+                    ops(ara));
+            ara->closed[c] = ara->pass;
+            const search_cell_t *cell = &map->cells[c];
+            for (int m = 0; m < 4; ++m) {
+                const int x = cell->x + moves[m][0];
+                const int y = cell->y + moves[m][1];
+                if (search_bits_test(&map->bits, x, y)) {
+                    continue;
+                }
+                const int n = x + (map->dim_x*y);
+                touch(ara, n);
+                if (ara->g[n] <= (ara->g[c]+1)) {
+                    continue;
+                }
+                ara->g[n] = ara->g[c]+1;
+                ara->parent[n] = c;
+                if (ara->closed[n] != ara->pass) {
+                    heap_push(ara, n);
+                } else if (ara->incons[n] != ara->pass) {
+                    ara->incons[n] = ara->pass;
+                    ara->incons_list[ara->incons_count++] = n;
+                }
+            }
+        }
+
+        // The pass is complete. Without a path, there's none to be had.
+        if (spent || (ara->g[ara->goal] >= infinity)) {
+            break;
+        }
+        ara->bound = ara->epsilon;
+        if (ara->epsilon == 10) {
+            break;
+        }
+        next_pass(ara);
+    }
+    if (ara->g[ara->goal] >= infinity) {
+        return 1;
+    }
+
+    // Parents always lead back to the start, and the path they trace is no
+    // longer than the goal's g.
+    search_cell_t *c = &map->cells[ara->goal];
+    c->next = 0;
+    while (ara->parent[c - map->cells] >= 0) {
+        search_cell_t *p = &map->cells[ara->parent[c - map->cells]];
+        p->next = c;
+        c->prev = p;
+        c = p;
+    }
+    c->prev = 0;
+    return 0;
+}
@@ -0,0 +1,79 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_ara_h_
+#define _search_ara_h_
+
+#include "search.h"
+
+// An anytime planner (ARA*). It first runs a weighted A* that inflates the
+// heuristic by epsilon, which finds a path quickly that's at most epsilon
+// times longer than the shortest. Each later pass lowers epsilon and reuses
+// the work already done, until epsilon reaches 1 and the path is the
+// shortest. search_ara_find stops when its budget runs out and returns the
+// best path so far; the next call carries on where it stopped.
+//
+// epsilon is kept in tenths, so 10 is an unweighted search.
+// All per cell state is indexed by the cell's position in map->cells.
+typedef struct {
+    search_map_t *map;
+
+    // cost from the start, and the cell it was reached from.
+    int *g, *parent;
+
+    // the open list, a binary min-heap of cell indices ordered by key.
+    int *heap, heap_count;
+    int *heap_index;
+    int *key;
+
+    // the pass that closed each cell, and the pass that marked each cell
+    // inconsistent: improved after it was closed. Passes keep counting up
+    // across queries, so neither needs clearing. The cells marked in this
+    // pass are also listed, so the next pass needn't scan the map.
+    unsigned *closed, *incons;
+    unsigned pass;
+    int *incons_list, incons_count;
+
+    // the query each cell's g, parent and heap_index belong to. Cells from
+    // an older query are reset on first touch, so starting a query is O(1).
+    unsigned *generation;
+    unsigned query;
+
+    // the current inflation, and how much each pass lowers it.
+    int epsilon, epsilon_step;
+
+    // the inflation of the last completed pass: the path is at most bound
+    // tenths as long as the shortest, or 0 if no pass has completed.
+    int bound;
+
+    // the start and goal, -1 until the planner is initialized.
+    int start, goal;
+} search_ara_t;
+
+// Return non-zero once the caller's time budget has run out.
+typedef int (*search_expired_t)(void *context);
+
+// Allocate planner state for the map from the heap.
+// Returns zero on success, non-zero on failure.
+int search_ara_alloc(search_ara_t *ara, search_map_t *map);
+
+// Start planning from start to goal with the given initial inflation and
+// step, both in tenths, discarding any previous plan.
+void search_ara_initialize(search_ara_t *ara, search_cell_t *start,
+        search_cell_t *goal, int epsilon, int epsilon_step);
+
+// Improve the plan until it's the shortest path or the budget runs out:
+// after max_expansions cells are expanded (0 for no limit), or once expired
+// returns non-zero (null for no limit). expired is polled every few dozen
+// expansions, and not before the first few dozen, so every call makes some
+// progress. On success the best path so far is threaded through the cells'
+// prev and next fields, just like search_find.
+// Returns zero if a path is threaded, non-zero if none is known yet.
+int search_ara_find(search_ara_t *ara, int max_expansions,
+        search_expired_t expired, void *context);
+
+// Return non-zero once the threaded path is known to be the shortest.
+int search_ara_optimal(const search_ara_t *ara);
+
+// Free any dynamic memory associated with the planner.
+void search_ara_free(search_ara_t *ara);
+#endif
@@ -0,0 +1,283 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#include <iostream>
+#include <cstdlib>
+#include <limits>
+
+extern "C" {
+#include "search_bidir.h"
+}
+#include "search_heap.h"
+
+static const int infinity = std::numeric_limits<int>::max()/4;
+
+static const int moves[][2] = {{-1,0},{1,0},{0,-1},{0,1}};
+
+enum { forward = 0, backward = 1 };
+
+// Twice the forward heuristic: the estimate to the goal less the estimate to
+// the start. The backward heuristic is its negation.
+static int h_twice(const search_map_t *map, int c, int start, int goal)
+{
+    const int dim_x = map->dim_x;
+    const int x = c%dim_x, y = c/dim_x;
+    const int to_goal = std::abs(x-(goal%dim_x)) + std::abs(y-(goal/dim_x));
+    const int to_start = std::abs(x-(start%dim_x)) + std::abs(y-(start/dim_x));
+    return to_goal - to_start;
+}
+
+// How far a cell strays from the straight line between start and goal, in
+// arbitrary units. Among cells that are equally good, both sides prefer the
+// ones nearest the line, so they meet in the middle rather than passing each
+// other along opposite edges of an open area.
+static int off_line(const search_map_t *map, int c, int start, int goal)
+{
+    const int dim_x = map->dim_x;
+    const int sx = start%dim_x, sy = start/dim_x;
+    const int cross = ((c%dim_x)-sx)*((goal/dim_x)-sy)
+        - ((c/dim_x)-sy)*((goal%dim_x)-sx);
+    return std::abs(cross);
+}
+
+// The Manhattan distance between two cells.
+static int distance(const search_map_t *map, int a, int b)
+{
+    const int dim_x = map->dim_x;
+    return std::abs((a%dim_x)-(b%dim_x)) + std::abs((a/dim_x)-(b/dim_x));
+}
+
+// Reset both sides' state for a cell if it belongs to an older query.
+static void touch(search_bidir_t *b, int c)
+{
+    if (b->generation[c] != b->query) {
+        b->generation[c] = b->query;
+        for (int s = 0; s < 2; ++s) {
+            b->side[s].g[c] = infinity;
+            b->side[s].parent[c] = -1;
+            b->side[s].heap_index[c] = -1;
+        }
+    }
+}
+
+// Open list order. Ties on the key go to the cell that's furthest along,
+// then to the cell nearest the line between start and goal.
+static bool key_less(const search_bidir_side_t *s, int x, int y)
+{
+    if (s->key[x] != s->key[y]) {
+        return s->key[x] < s->key[y];
+    }
+    if (s->g[x] != s->g[y]) {
+        return s->g[x] > s->g[y];
+    }
+    return s->tie[x] < s->tie[y];
+}
+
+namespace {
+
+// One side's open list order and positions, for search_heap.h.
+struct bidir_heap_ops {
+    search_bidir_side_t *s;
+
+    bool less(int x, int y) const
+    {
+        return key_less(s, x, y);
+    }
+
+    int index(int c) const
+    {
+        return s->heap_index[c];
+    }
+
+    void place(int c, int i) const
+    {
+        s->heap_index[c] = i;
+    }
+};
+
+bidir_heap_ops ops(search_bidir_side_t *s)
+{
+    const bidir_heap_ops o = { s };
+    return o;
+}
+
+}
+
+// Reach c on one side at cost g from parent, if that's better than what it
+// has.
+static void relax(search_bidir_t *b, int side, int c, int parent, int g,
+        int start, int goal)
+{
+    search_bidir_side_t *s = &b->side[side];
+    if (g >= s->g[c]) {
+        return;
+    }
+    const int h = h_twice(b->map, c, start, goal);
+    s->g[c] = g;
+    s->parent[c] = parent;
+    s->key[c] = (2*g) + ((side == forward) ? h : -h);
+    s->tie[c] = off_line(b->map, c, start, goal);
+    search_heap_decrease(s->heap, &s->heap_count, c, ops(s));
+}
+
+int search_bidir_alloc(search_bidir_t *bidir, search_map_t *map)
+{
+    const int cells = map->dim_x*map->dim_y;
+    bidir->map = map;
+    int failed = 0;
+    for (int s = 0; s < 2; ++s) {
+        search_bidir_side_t *side = &bidir->side[s];
+        side->g = (int*)malloc(sizeof(int)*cells);
+        side->parent = (int*)malloc(sizeof(int)*cells);
+        side->heap = (int*)malloc(sizeof(int)*cells);
+        side->heap_index = (int*)malloc(sizeof(int)*cells);
+        side->key = (int*)malloc(sizeof(int)*cells);
+        side->tie = (int*)malloc(sizeof(int)*cells);
+        side->closed = (unsigned*)calloc(cells, sizeof(unsigned));
+        side->heap_count = 0;
+        failed |= !side->g || !side->parent || !side->heap ||
+            !side->heap_index || !side->key || !side->tie || !side->closed;
+    }
+    bidir->generation = (unsigned*)calloc(cells, sizeof(unsigned));
+    bidir->query = 0;
+    bidir->expanded = 0;
+    if (failed || !bidir->generation) {
+        std::cout << "malloc failed" << std::endl;
+        search_bidir_free(bidir);
+        return 1;
+    }
+    return 0;
+}
+
+void search_bidir_free(search_bidir_t *bidir)
+{
+    for (int s = 0; s < 2; ++s) {
+        search_bidir_side_t *side = &bidir->side[s];
+        free(side->g);
+        free(side->parent);
+        free(side->heap);
+        free(side->heap_index);
+        free(side->key);
+        free(side->tie);
+        free(side->closed);
+        side->g = side->parent = side->heap = side->heap_index = side->key = 0;
+        side->tie = 0;
+        side->closed = 0;
+        side->heap_count = 0;
+    }
+    free(bidir->generation);
+    bidir->generation = 0;
+}
+
+int search_bidir_find(search_bidir_t *bidir, search_cell_t *start,
+        search_cell_t *goal)
+{
+    search_map_t *map = bidir->map;
+    const int s = start - map->cells;
+    const int t = goal - map->cells;
+    bidir->expanded = 0;
+
+    // The goal is never entered if it's blocked, just as with search_find.
+    if (search_bits_test(&map->bits, goal->x, goal->y)) {
+        return 1;
+    }
+
+    // A fresh query makes every cell stale. When the counter wraps, a stale
+    // cell could look current again, so fall back to a full reset.
+    if (!++bidir->query) {
+        const int cells = map->dim_x*map->dim_y;
+        for (int c = 0; c < cells; ++c) {
+            bidir->generation[c] = 0;
+            bidir->side[forward].closed[c] = bidir->side[backward].closed[c] = 0;
+        }
+        bidir->query = 1;
+    }
+    bidir->side[forward].heap_count = bidir->side[backward].heap_count = 0;
+    touch(bidir, s);
+    touch(bidir, t);
+    relax(bidir, forward, s, -1, 0, s, t);
+    relax(bidir, backward, t, -1, 0, s, t);
+
+    // The best path so far, and the step where its two halves meet.
+    int best = (s == t) ? 0 : infinity;
+    int meet_forward = s, meet_backward = t;
+
+    for (;;) {
+        search_bidir_side_t *f = &bidir->side[forward];
+        search_bidir_side_t *r = &bidir->side[backward];
+        if (!f->heap_count || !r->heap_count) {
+            break;
+        }
+
+        // The keys are doubled, and the averaged heuristics of the two sides
+        // cancel, so the two smallest keys together bound every path not yet
+        // found.
+        if ((f->key[f->heap[0]] + r->key[r->heap[0]]) >= (2*best)) {
+            break;
+        }
+
+        // Expand the side with the smaller open list.
+        const int side = (f->heap_count <= r->heap_count) ? forward : backward;
+        search_bidir_side_t *own = &bidir->side[side];
+        search_bidir_side_t *other = &bidir->side[!side];
+        const int c = search_heap_pop(own->heap, &own->heap_count, ops(own));
+        own->closed[c] = bidir->query;
+
+        // A cell that can't reach the far end in fewer steps than the best
+        // path so far can't be on a shorter one.
+        const int far = (side == forward) ? t : s;
+        if ((own->g[c] + distance(map, c, far)) >= best) {
+            continue;
+        }
+        ++bidir->expanded;
+
+        const search_cell_t *cell = &map->cells[c];
+        for (int m = 0; m < 4; ++m) {
+            const int x = cell->x + moves[m][0];
+            const int y = cell->y + moves[m][1];
+            if (search_bits_test(&map->bits, x, y)) {
+                continue;
+            }
+            const int n = x + (map->dim_x*y);
+            touch(bidir, n);
+
+            // A step onto a cell the other side has reached joins the two
+            // searches.
+            if ((own->g[c] + 1 + other->g[n]) < best) {
+                best = own->g[c] + 1 + other->g[n];
+                meet_forward = (side == forward) ? c : n;
+                meet_backward = (side == forward) ? n : c;
+            }
+            if ((own->closed[n] != bidir->query) &&
+                    ((own->g[c] + 1 + distance(map, n, far)) < best)) {
+                relax(bidir, side, n, c, own->g[c] + 1, s, t);
+            }
+        }
+    }
+    if (best >= infinity) {
+        return 1;
+    }
+
+    // Thread the forward half back from where the searches met, then the
+    // backward half on to the goal.
+    search_cell_t *c = &map->cells[meet_forward];
+    c->next = 0;
+    while (bidir->side[forward].parent[c - map->cells] >= 0) {
+        search_cell_t *p = &map->cells[bidir->side[forward].parent[c - map->cells]];
+        p->next = c;
+        c->prev = p;
+        c = p;
+    }
+    c->prev = 0;
+    if (s == t) {
+        return 0;
+    }
+    c = &map->cells[meet_forward];
+    for (int n = meet_backward; n >= 0; n = bidir->side[backward].parent[n]) {
+        search_cell_t *next = &map->cells[n];
+        c->next = next;
+        next->prev = c;
+        c = next;
+    }
+    c->next = 0;
+    return 0;
+}
@@ -0,0 +1,65 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_bidir_h_
+#define _search_bidir_h_
+
+#include "search.h"
+
+// A bidirectional A* planner. One search grows from the start toward the
+// goal and another from the goal toward the start, and they stop once they
+// meet and nothing left open could make a shorter path. On long routes the
+// two small searches expand far fewer cells than one large one.
+//
+// Both searches use the same, averaged heuristic: half the estimate to the
+// goal minus half the estimate to the start, negated for the backward
+// search. That keeps both consistent, so the stopping rule is the one for
+// bidirectional Dijkstra: stop when the smallest forward and backward keys
+// together reach the best path found so far. Paths are the shortest.
+//
+// All per cell state is indexed by the cell's position in map->cells.
+typedef struct {
+    // cost from where the search began, and the cell it was reached from.
+    int *g, *parent;
+
+    // the open list, a binary min-heap of cell indices ordered by key, which
+    // is kept doubled so the averaged heuristic stays integral.
+    int *heap, heap_count;
+    int *heap_index;
+    int *key;
+
+    // breaks ties on key and g: how far each cell strays from the straight
+    // line between start and goal.
+    int *tie;
+
+    // the query that closed each cell.
+    unsigned *closed;
+} search_bidir_side_t;
+
+typedef struct {
+    search_map_t *map;
+
+    // the forward search from the start, and backward from the goal.
+    search_bidir_side_t side[2];
+
+    // the query each cell's state belongs to. Cells from an older query are
+    // reset on first touch, so starting a query is O(1).
+    unsigned *generation;
+    unsigned query;
+
+    // the cells expanded by the last search, both sides together.
+    int expanded;
+} search_bidir_t;
+
+// Allocate planner state for the map from the heap.
+// Returns zero on success, non-zero on failure.
+int search_bidir_alloc(search_bidir_t *bidir, search_map_t *map);
+
+// Find the goal from start. On success the path is threaded through the
+// cells' prev and next fields, just like search_find.
+// Returns zero on success, non-zero if the goal can't be reached.
+int search_bidir_find(search_bidir_t *bidir, search_cell_t *start,
+        search_cell_t *goal);
+
+// Free any dynamic memory associated with the planner.
+void search_bidir_free(search_bidir_t *bidir);
+#endif
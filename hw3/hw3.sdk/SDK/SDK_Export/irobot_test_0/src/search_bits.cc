@@ -0,0 +1,239 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+#include "search_bits.h"
+}
+
+static const uint64_t all = ~(uint64_t)0;
+
+// The bits past dim_x in the last word of a row.
+static uint64_t padding(const search_bits_t *bits)
+{
+    const int used = bits->dim_x & 63;
+    return used ? (all << used) : 0;
+}
+
+static uint64_t* row(const search_bits_t *bits, int y)
+{
+    return &bits->rows[bits->words*y];
+}
+
+int search_bits_alloc(search_bits_t *bits, int dim_x, int dim_y)
+{
+    bits->dim_x = dim_x;
+    bits->dim_y = dim_y;
+    bits->words = (dim_x+63)/64;
+    bits->rows = (uint64_t*)malloc(sizeof(uint64_t)*bits->words*dim_y);
+    if (!bits->rows) {
+        std::cout << "malloc failed" << std::endl;
+        return 1;
+    }
+    search_bits_clear(bits);
+    return 0;
+}
+
+void search_bits_free(search_bits_t *bits)
+{
+    free(bits->rows);
+    bits->rows = 0;
+    bits->dim_x = bits->dim_y = bits->words = 0;
+}
+
+void search_bits_clear(search_bits_t *bits)
+{
+    memset(bits->rows, 0, sizeof(uint64_t)*bits->words*bits->dim_y);
+    for (int y = 0; y < bits->dim_y; ++y) {
+        row(bits,y)[bits->words-1] |= padding(bits);
+    }
+}
+
+void search_bits_set(search_bits_t *bits, int x, int y, int blocked)
+{
+    uint64_t *w = &row(bits,y)[x>>6];
+    const uint64_t bit = (uint64_t)1 << (x&63);
+    if (blocked) {
+        *w |= bit;
+    } else {
+        *w &= ~bit;
+    }
+}
+
+int search_bits_test(const search_bits_t *bits, int x, int y)
+{
+    if ((x < 0) || (y < 0) || (x >= bits->dim_x) || (y >= bits->dim_y)) {
+        return 1;
+    }
+    return (row(bits,y)[x>>6] >> (x&63)) & 1;
+}
+
+int search_bits_neighbors(const search_bits_t *bits, int x, int y)
+{
+    // Read the word holding x in this row and the rows above and below.
+    // Only a cell at the end of a word needs the word beside it; the padding
+    // answers for the right edge of the map.
+    const int w = x >> 6;
+    const int b = x & 63;
+    const uint64_t *r = row(bits,y);
+    const uint64_t current = r[w];
+    int left, right;
+    if (b) {
+        left = (current >> (b-1)) & 1;
+    } else {
+        left = w ? (r[w-1] >> 63) : 1;
+    }
+    if (b != 63) {
+        right = (current >> (b+1)) & 1;
+    } else {
+        right = ((w+1) < bits->words) ? (r[w+1] & 1) : 1;
+    }
+    const int above = (y > 0) ? ((row(bits,y-1)[w] >> b) & 1) : 1;
+    const int below = ((y+1) < bits->dim_y) ? ((row(bits,y+1)[w] >> b) & 1) : 1;
+    return left | (right << 1) | (above << 2) | (below << 3);
+}
+
+// Return the cells of word w of side row s whose cell behind, coming from
+// direction dx, is blocked and which are themselves free.
+static uint64_t forced(const search_bits_t *bits, const uint64_t *s, int w,
+        int dx)
+{
+    if (!s) {
+        return 0;
+    }
+    uint64_t behind;
+    if (dx > 0) {
+        behind = (s[w] << 1) | (w ? (s[w-1] >> 63) : 1);
+    } else {
+        behind = (s[w] >> 1) | (((w+1) < bits->words) ? (s[w+1] << 63) : 0);
+    }
+    return ~s[w] & behind;
+}
+
+int search_bits_run(const search_bits_t *bits, int x, int y, int dx,
+        int *blocked)
+{
+    const int start = x + dx;
+    if ((start < 0) || (start >= bits->dim_x)) {
+        *blocked = 1;
+        return start;
+    }
+
+    // The run stops at the first blocked cell or forced neighbor.
+    const uint64_t *r = row(bits,y);
+    const uint64_t *above = (y > 0) ? row(bits,y-1) : 0;
+    const uint64_t *below = ((y+1) < bits->dim_y) ? row(bits,y+1) : 0;
+    int w = start >> 6;
+    uint64_t stop;
+    if (dx > 0) {
+        stop = (r[w] | forced(bits,above,w,dx) | forced(bits,below,w,dx))
+            & (all << (start&63));
+        while (!stop) {
+            if (++w == bits->words) {
+                *blocked = 1;
+                return bits->dim_x;
+            }
+            stop = r[w] | forced(bits,above,w,dx) | forced(bits,below,w,dx);
+        }
+        x = (w*64) + __builtin_ctzll(stop);
+    } else {
+        stop = (r[w] | forced(bits,above,w,dx) | forced(bits,below,w,dx))
+            & (all >> (63-(start&63)));
+        while (!stop) {
+            if (--w < 0) {
+                *blocked = 1;
+                return -1;
+            }
+            stop = r[w] | forced(bits,above,w,dx) | forced(bits,below,w,dx);
+        }
+        x = (w*64) + 63 - __builtin_clzll(stop);
+    }
+    *blocked = (x >= bits->dim_x) || ((r[x>>6] >> (x&63)) & 1);
+    return x;
+}
+
+// Fill a word toward the high bits from the seeds through the free cells.
+// This is a Kogge-Stone occluded fill: six shifts cover all 64 bits.
+static uint64_t fill_up(uint64_t seed, uint64_t open)
+{
+    seed |= open & (seed << 1);  open &= open << 1;
+    seed |= open & (seed << 2);  open &= open << 2;
+    seed |= open & (seed << 4);  open &= open << 4;
+    seed |= open & (seed << 8);  open &= open << 8;
+    seed |= open & (seed << 16); open &= open << 16;
+    seed |= open & (seed << 32);
+    return seed;
+}
+
+// Fill a word toward the low bits from the seeds through the free cells.
+static uint64_t fill_down(uint64_t seed, uint64_t open)
+{
+    seed |= open & (seed >> 1);  open &= open >> 1;
+    seed |= open & (seed >> 2);  open &= open >> 2;
+    seed |= open & (seed >> 4);  open &= open >> 4;
+    seed |= open & (seed >> 8);  open &= open >> 8;
+    seed |= open & (seed >> 16); open &= open >> 16;
+    seed |= open & (seed >> 32);
+    return seed;
+}
+
+// Seed row y of reached from its neighbors, then fill each seed out to the
+// ends of its free run. Returns non-zero if anything new was reached.
+static int flood_row(const search_bits_t *bits, search_bits_t *reached, int y)
+{
+    const int words = bits->words;
+    const uint64_t *b = row(bits,y);
+    const uint64_t *above = (y > 0) ? row(reached,y-1) : 0;
+    const uint64_t *below = ((y+1) < bits->dim_y) ? row(reached,y+1) : 0;
+    uint64_t *r = row(reached,y);
+
+    int changed = 0;
+    uint64_t carry = 0;
+    for (int w = 0; w < words; ++w) {
+        uint64_t seed = r[w] | (above ? above[w] : 0) | (below ? below[w] : 0);
+        seed = fill_up((seed | carry) & ~b[w], ~b[w]);
+        carry = (seed >> 63) & 1;
+        changed |= (seed != r[w]);
+        r[w] = seed;
+    }
+    carry = 0;
+    for (int w = words-1; w >= 0; --w) {
+        const uint64_t seed = fill_down((r[w] | carry) & ~b[w], ~b[w]);
+        carry = (seed & 1) << 63;
+        changed |= (seed != r[w]);
+        r[w] = seed;
+    }
+    return changed;
+}
+
+int search_bits_flood(const search_bits_t *bits, int x, int y,
+        search_bits_t *reached)
+{
+    memset(reached->rows, 0, sizeof(uint64_t)*reached->words*reached->dim_y);
+    if (search_bits_test(bits, x, y)) {
+        return 0;
+    }
+    search_bits_set(reached, x, y, 1);
+
+    // Sweep down and back up until nothing new is reached. Each sweep
+    // carries the fill through every run it touches, so the number of sweeps
+    // follows the number of turns in the free space, not its area.
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int j = y; j < bits->dim_y; ++j) {
+            changed |= flood_row(bits, reached, j);
+        }
+        for (int j = bits->dim_y-1; j >= 0; --j) {
+            changed |= flood_row(bits, reached, j);
+        }
+    }
+
+    int count = 0;
+    for (int i = 0; i < reached->words*reached->dim_y; ++i) {
+        count += __builtin_popcountll(reached->rows[i]);
+    }
+    return count;
+}
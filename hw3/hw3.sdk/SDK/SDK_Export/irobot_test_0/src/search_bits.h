@@ -0,0 +1,49 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_bits_h_
+#define _search_bits_h_
+
+#include <stdint.h>
+
+// An occupancy bitboard: one bit per cell, set if the cell is blocked. Each
+// row is stored as whole 64-bit words, so scans along a row and flood fill
+// work a word at a time. Bits past dim_x in the last word of each
+// row are kept set, so runs stop at the edge of the map on their own.
+typedef struct {
+    int dim_x, dim_y;
+    int words;
+    uint64_t *rows;
+} search_bits_t;
+
+// Allocate a bitboard with every cell unblocked.
+// Returns zero on success, non-zero on failure.
+int search_bits_alloc(search_bits_t *bits, int dim_x, int dim_y);
+
+// Unblock every cell.
+void search_bits_clear(search_bits_t *bits);
+
+// Set or test the blocked state of a cell. Cells off the map test blocked.
+void search_bits_set(search_bits_t *bits, int x, int y, int blocked);
+int search_bits_test(const search_bits_t *bits, int x, int y);
+
+// Return a mask of the blocked or off-map neighbors of x,y, which must be on
+// the map. Bits 0 through 3 are the neighbors at x-1, x+1, y-1 and y+1.
+int search_bits_neighbors(const search_bits_t *bits, int x, int y);
+
+// Run along row y from x in direction dx (+1 or -1), not counting x. Return
+// the first x where the run must stop: either the cell is blocked or off the
+// map, in which case blocked is set, or the cell has a free neighbor above or
+// below whose cell behind (toward x) is blocked. These are the forced
+// neighbors of jump point search.
+int search_bits_run(const search_bits_t *bits, int x, int y, int dx,
+        int *blocked);
+
+// Flood fill the free space reachable from x,y into reached, which must have
+// the same dimensions as bits. Reached cells are set.
+// Returns the number of cells reached.
+int search_bits_flood(const search_bits_t *bits, int x, int y,
+        search_bits_t *reached);
+
+// Free any dynamic memory associated with the bitboard.
+void search_bits_free(search_bits_t *bits);
+#endif
@@ -0,0 +1,41 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_context_h_
+#define _search_context_h_
+
+#include "search_path.h"
+
+// Search state for one query at a time, kept apart from the map it searches.
+// search_find keeps g, prev, the open list and the rest in the map's own
+// cells, so only one search can run on a map. A context holds its own copy
+// of all of that, and reads only the map's bitboard, so several contexts,
+// one per thread, can search the same map at once: for several robots, or
+// several candidate goals.
+//
+// The map's blocked cells must not change while any context searches it;
+// callers that update the map concurrently should hold a lock (a pthread
+// rwlock suits) around updates and searches.
+typedef struct {
+    // the shared map.
+    search_map_t *map;
+
+    // the context's own cells, open list and generation, shaped like the
+    // map. Its bitboard is the map's, borrowed, never written.
+    search_map_t scratch;
+} search_context_t;
+
+// Allocate a context for searching the map from the heap.
+// Returns zero on success, non-zero on failure.
+int search_context_alloc(search_context_t *context, search_map_t *map);
+
+// Find the goal from start, both cells of the shared map, writing the path
+// to path. The map's cells aren't touched. Starting a query is O(1), as with
+// search_map_initialize.
+// Returns zero on success, non-zero if the goal can't be reached or the path
+// doesn't fit.
+int search_context_find(search_context_t *context, const search_cell_t *start,
+        const search_cell_t *goal, search_mode_t mode, search_path_t *path);
+
+// Free any dynamic memory associated with the context. The map is left be.
+void search_context_free(search_context_t *context);
+#endif
@@ -0,0 +1,342 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+#include "search_coverage.h"
+}
+
+// Whether the cell at pos along lane is blocked on the map.
+static int lane_blocked(const search_coverage_t *cov, int rows, int lane,
+        int pos)
+{
+    return rows ? search_bits_test(&cov->map->bits, pos, lane) :
+        search_bits_test(&cov->map->bits, lane, pos);
+}
+
+// Count the segments the map's lanes would hold, as rows or columns.
+static int lane_count(const search_coverage_t *cov, int rows)
+{
+    const search_map_t *map = cov->map;
+    const int lanes = rows ? map->dim_y : map->dim_x;
+    const int length = rows ? map->dim_x : map->dim_y;
+    int count = 0;
+    for (int l = 0; l < lanes; ++l) {
+        int free = 0;
+        for (int p = 0; p < length; ++p) {
+            const int f = !lane_blocked(cov, rows, l, p);
+            if (f && !free) {
+                ++count;
+            }
+            free = f;
+        }
+    }
+    return count;
+}
+
+// Cut a lane into segments, unlinked.
+static void lane_build(search_coverage_t *cov, int l)
+{
+    search_coverage_segment_t *s = &cov->segments[l*cov->per_lane];
+    int n = 0;
+    for (int p = 0; p < cov->length; ++p) {
+        if (lane_blocked(cov, cov->rows, l, p)) {
+            continue;
+        }
+        if (n && (s[n-1].hi == (p-1))) {
+            s[n-1].hi = p;
+        } else {
+            s[n].lo = s[n].hi = p;
+            s[n].prev = s[n].next = -1;
+            ++n;
+        }
+    }
+    cov->count[l] = n;
+}
+
+static int overlap(const search_coverage_segment_t *a,
+        const search_coverage_segment_t *b)
+{
+    return (a->lo <= b->hi) && (b->lo <= a->hi);
+}
+
+// Link the cells across lanes l and l+1. Segments that overlap each other
+// and nothing else are the same cell. Overlapping pairs are found by merging
+// the two lanes, since each is in order.
+static void lane_link(search_coverage_t *cov, int l)
+{
+    const int base_a = l*cov->per_lane, base_b = (l+1)*cov->per_lane;
+    search_coverage_segment_t *a = &cov->segments[base_a];
+    search_coverage_segment_t *b = &cov->segments[base_b];
+    int *overlaps_a = &cov->overlaps[base_a], *overlaps_b = &cov->overlaps[base_b];
+    const int na = cov->count[l], nb = cov->count[l+1];
+    int i, j;
+    for (i = 0; i < na; ++i) {
+        a[i].next = -1;
+        overlaps_a[i] = 0;
+    }
+    for (j = 0; j < nb; ++j) {
+        b[j].prev = -1;
+        overlaps_b[j] = 0;
+    }
+    for (int pass = 0; pass < 2; ++pass) {
+        i = j = 0;
+        while ((i < na) && (j < nb)) {
+            if (overlap(&a[i], &b[j])) {
+                if (!pass) {
+                    ++overlaps_a[i];
+                    ++overlaps_b[j];
+                } else if ((overlaps_a[i] == 1) && (overlaps_b[j] == 1)) {
+                    a[i].next = base_b + j;
+                    b[j].prev = base_a + i;
+                }
+            }
+            if (a[i].hi < b[j].hi) {
+                ++i;
+            } else {
+                ++j;
+            }
+        }
+    }
+}
+
+int search_coverage_alloc(search_coverage_t *coverage, search_map_t *map)
+{
+    const int dim_max = (map->dim_x > map->dim_y) ? map->dim_x : map->dim_y;
+    const int rows = map->dim_y*((map->dim_x+1)/2);
+    const int columns = map->dim_x*((map->dim_y+1)/2);
+    const int segments = (rows > columns) ? rows : columns;
+    coverage->map = map;
+    coverage->rows = 1;
+    coverage->lanes = coverage->length = coverage->per_lane = 0;
+    coverage->segments = (search_coverage_segment_t*)malloc(
+            sizeof(search_coverage_segment_t)*segments);
+    coverage->count = (int*)calloc(dim_max, sizeof(int));
+    coverage->dirty = (unsigned char*)calloc(dim_max, 1);
+    coverage->overlaps = (int*)malloc(sizeof(int)*segments);
+    coverage->tail = (int*)malloc(sizeof(int)*segments);
+    coverage->routed = (unsigned char*)malloc(segments);
+    coverage->blocked.rows = 0;
+    if (!coverage->segments || !coverage->count || !coverage->dirty ||
+            !coverage->overlaps || !coverage->tail || !coverage->routed ||
+            search_bits_alloc(&coverage->blocked, map->dim_x, map->dim_y)) {
+        std::cout << "malloc failed" << std::endl;
+        search_coverage_free(coverage);
+        return 1;
+    }
+    return 0;
+}
+
+int search_coverage_decompose(search_coverage_t *coverage)
+{
+    search_map_t *map = coverage->map;
+
+    // Fewer segments means fewer lane changes. On a tie, take the longer
+    // lanes.
+    const int rows = lane_count(coverage, 1);
+    const int columns = lane_count(coverage, 0);
+    coverage->rows = (rows < columns) ||
+        ((rows == columns) && (map->dim_x >= map->dim_y));
+    coverage->lanes = coverage->rows ? map->dim_y : map->dim_x;
+    coverage->length = coverage->rows ? map->dim_x : map->dim_y;
+    coverage->per_lane = (coverage->length+1)/2;
+    for (int l = 0; l < coverage->lanes; ++l) {
+        lane_build(coverage, l);
+    }
+    for (int l = 0; (l+1) < coverage->lanes; ++l) {
+        lane_link(coverage, l);
+    }
+    memcpy(coverage->blocked.rows, map->bits.rows,
+            sizeof(uint64_t)*map->bits.words*map->dim_y);
+    return coverage->rows ? rows : columns;
+}
+
+int search_coverage_sync(search_coverage_t *coverage)
+{
+    search_map_t *map = coverage->map;
+    const int words = map->bits.words;
+
+    // Find the lanes holding a cell that changed, a word at a time.
+    int changed = 0;
+    for (int y = 0; y < map->dim_y; ++y) {
+        for (int w = 0; w < words; ++w) {
+            uint64_t diff = map->bits.rows[(y*words)+w] ^
+                coverage->blocked.rows[(y*words)+w];
+            while (diff) {
+                const int x = (w*64) + __builtin_ctzll(diff);
+                diff &= diff-1;
+                const int l = coverage->rows ? y : x;
+                if (!coverage->dirty[l]) {
+                    coverage->dirty[l] = 1;
+                    ++changed;
+                }
+            }
+        }
+    }
+    if (!changed) {
+        return 0;
+    }
+
+    // Rebuild those lanes, and relink them to the lanes either side.
+    int l;
+    for (l = 0; l < coverage->lanes; ++l) {
+        if (coverage->dirty[l]) {
+            lane_build(coverage, l);
+        }
+    }
+    for (l = 0; (l+1) < coverage->lanes; ++l) {
+        if (coverage->dirty[l] || coverage->dirty[l+1]) {
+            lane_link(coverage, l);
+        }
+    }
+    for (l = 0; l < coverage->lanes; ++l) {
+        coverage->dirty[l] = 0;
+    }
+    memcpy(coverage->blocked.rows, map->bits.rows,
+            sizeof(uint64_t)*words*map->dim_y);
+    return changed;
+}
+
+// Whether every cell of a segment is set in swept.
+static int segment_swept(const search_coverage_t *cov,
+        const search_bits_t *swept, int s)
+{
+    const int l = s/cov->per_lane;
+    for (int p = cov->segments[s].lo; p <= cov->segments[s].hi; ++p) {
+        const int x = cov->rows ? p : l;
+        const int y = cov->rows ? l : p;
+        if (!search_bits_test(swept, x, y)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Append a waypoint at pos along lane, unless it's where we already are.
+// Returns non-zero once coords is full.
+static int route_emit(const search_coverage_t *cov, int lane, int pos,
+        int *at_lane, int *at_pos, int *coords, int *written, int max)
+{
+    if ((lane == *at_lane) && (pos == *at_pos)) {
+        return 0;
+    }
+    if (*written >= max) {
+        return 1;
+    }
+    coords[(2*(*written))] = cov->rows ? pos : lane;
+    coords[(2*(*written))+1] = cov->rows ? lane : pos;
+    ++*written;
+    *at_lane = lane;
+    *at_pos = pos;
+    return 0;
+}
+
+int search_coverage_route(search_coverage_t *coverage,
+        const search_bits_t *swept, int x, int y, int *coords, int max)
+{
+    search_coverage_t *cov = coverage;
+    const int per_lane = cov->per_lane;
+    int s;
+
+    // Segments already swept don't need routing, and every cell's first
+    // segment knows its last.
+    for (int l = 0; l < cov->lanes; ++l) {
+        for (int i = 0; i < cov->count[l]; ++i) {
+            s = (l*per_lane) + i;
+            cov->routed[s] = swept && segment_swept(cov, swept, s);
+        }
+    }
+    for (int l = 0; l < cov->lanes; ++l) {
+        for (int i = 0; i < cov->count[l]; ++i) {
+            s = (l*per_lane) + i;
+            if (cov->segments[s].prev < 0) {
+                int t = s;
+                while (cov->segments[t].next >= 0) {
+                    t = cov->segments[t].next;
+                }
+                cov->tail[s] = t;
+            }
+        }
+    }
+
+    int at_lane = cov->rows ? y : x;
+    int at_pos = cov->rows ? x : y;
+    int written = 0;
+    for (;;) {
+
+        // Find the nearest corner of a cell with something left to sweep.
+        int best = -1, best_cost = 0, best_end = 0;
+        for (int l = 0; l < cov->lanes; ++l) {
+            for (int i = 0; i < cov->count[l]; ++i) {
+                s = (l*per_lane) + i;
+                if (cov->segments[s].prev >= 0) {
+                    continue;
+                }
+                int t = s;
+                while ((t >= 0) && cov->routed[t]) {
+                    t = cov->segments[t].next;
+                }
+                if (t < 0) {
+                    continue;
+                }
+                for (int end = 0; end < 2; ++end) {
+                    const int e = end ? cov->tail[s] : s;
+                    const int dl = abs((e/per_lane) - at_lane);
+                    const int lo = abs(cov->segments[e].lo - at_pos);
+                    const int hi = abs(cov->segments[e].hi - at_pos);
+                    const int cost = dl + ((lo < hi) ? lo : hi);
+                    if ((best < 0) || (cost < best_cost)) {
+                        best = s;
+                        best_cost = cost;
+                        best_end = end;
+                    }
+                }
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+
+        // Sweep it lane by lane from that end, starting each lane from
+        // whichever end is nearer, which turns back and forth.
+        s = best_end ? cov->tail[best] : best;
+        while (s >= 0) {
+            const search_coverage_segment_t *seg = &cov->segments[s];
+            if (!cov->routed[s]) {
+                const int l = s/per_lane;
+                const int near_lo =
+                    abs(seg->lo - at_pos) <= abs(seg->hi - at_pos);
+                const int from = near_lo ? seg->lo : seg->hi;
+                const int to = near_lo ? seg->hi : seg->lo;
+                if (route_emit(cov, l, from, &at_lane, &at_pos, coords,
+                            &written, max) ||
+                        route_emit(cov, l, to, &at_lane, &at_pos, coords,
+                            &written, max)) {
+                    return written;
+                }
+                cov->routed[s] = 1;
+            }
+            s = best_end ? seg->prev : seg->next;
+        }
+    }
+    return written;
+}
+
+void search_coverage_free(search_coverage_t *coverage)
+{
+    free(coverage->segments);
+    free(coverage->count);
+    free(coverage->dirty);
+    free(coverage->overlaps);
+    free(coverage->tail);
+    free(coverage->routed);
+    if (coverage->blocked.rows) {
+        search_bits_free(&coverage->blocked);
+    }
+    coverage->segments = 0;
+    coverage->count = coverage->overlaps = coverage->tail = 0;
+    coverage->dirty = coverage->routed = 0;
+    coverage->lanes = coverage->length = coverage->per_lane = 0;
+}
@@ -0,0 +1,78 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_coverage_h_
+#define _search_coverage_h_
+
+#include "search.h"
+#include "search_bits.h"
+
+// A boustrophedon coverage planner. The map's free space is cut into lanes,
+// one per row or column, and each lane into segments, its runs of free
+// cells. A segment continues the cell of the segment in the lane before when
+// the two overlap each other and nothing else; otherwise a new cell starts.
+// Every cell can then be swept lane by lane, back and forth, like mowing a
+// lawn, with each lane a single straight drive.
+//
+// Each lane change costs two turns, so the lanes run whichever way makes for
+// fewer segments, usually along the longer side of the arena.
+//
+// Whether a segment continues a cell only depends on its own lane and the
+// lanes either side, so when an obstacle turns up, only the lanes it's in
+// and their links to the lanes either side are rebuilt.
+typedef struct {
+    // the segment's free cells along its lane, lo through hi.
+    int lo, hi;
+
+    // the segment that continues this one's cell in the lane before and the
+    // lane after, -1 where the cell starts or ends.
+    int prev, next;
+} search_coverage_segment_t;
+
+typedef struct {
+    search_map_t *map;
+
+    // whether the lanes are rows, along x, rather than columns; the number of
+    // lanes, and the cells along each.
+    int rows;
+    int lanes, length;
+
+    // each lane's segments, in order along the lane: lane l's count[l]
+    // segments start at segments[l*per_lane].
+    search_coverage_segment_t *segments;
+    int *count, per_lane;
+
+    // the blocked cells the lanes were built from, so changes can be found.
+    search_bits_t blocked;
+
+    // scratch: per lane whether it changed, and per segment how many
+    // segments it overlaps in the next lane, the last segment of its cell,
+    // and whether it's been routed.
+    unsigned char *dirty;
+    int *overlaps, *tail;
+    unsigned char *routed;
+} search_coverage_t;
+
+// Allocate a planner for the map from the heap.
+// Returns zero on success, non-zero on failure.
+int search_coverage_alloc(search_coverage_t *coverage, search_map_t *map);
+
+// Cut the map into cells from scratch, choosing the lane direction.
+// Returns the number of segments.
+int search_coverage_decompose(search_coverage_t *coverage);
+
+// Bring the cells up to date with the map, rebuilding only the lanes whose
+// blocked cells changed since they were built.
+// Returns the number of lanes rebuilt.
+int search_coverage_sync(search_coverage_t *coverage);
+
+// Write the sweep of every cell as waypoints, x,y pairs, into coords, at most
+// max of them. From x,y, each cell is entered at whichever corner is
+// nearest, and its lanes are driven end to end, each from its nearer end.
+// Lanes whose cells are all set in swept, if not null, are left out.
+// Returns the number of waypoints written.
+int search_coverage_route(search_coverage_t *coverage,
+        const search_bits_t *swept, int x, int y, int *coords, int max);
+
+// Free any dynamic memory associated with the planner.
+void search_coverage_free(search_coverage_t *coverage);
+#endif
@@ -0,0 +1,288 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#include <iostream>
+#include <cstdlib>
+#include <limits>
+
+extern "C" {
+#include "search_cspace.h"
+}
+#include "search_heap.h"
+
+static const int infinity = std::numeric_limits<int>::max();
+
+// The wave spreads to all eight neighbors, so clearance is measured in any
+// direction, not just the directions the robot drives.
+static const int moves[][2] = {
+    {-1,0},{1,0},{0,-1},{0,1},{-1,-1},{1,-1},{-1,1},{1,1}};
+
+static int distance2(const search_map_t *map, int a, int b)
+{
+    const int dx = (a%map->dim_x) - (b%map->dim_x);
+    const int dy = (a/map->dim_x) - (b/map->dim_x);
+    return (dx*dx) + (dy*dy);
+}
+
+// Whether a cell should be blocked on the map.
+static int blocked(const search_cspace_t *cs, int c)
+{
+    if (cs->obstacle[c]) {
+        return 1;
+    }
+    if ((c == cs->exempt[0]) || (c == cs->exempt[1])) {
+        return 0;
+    }
+    return cs->distance[c] <= (cs->radius*cs->radius);
+}
+
+// Remember a cell's blocked state before its clearance first changes in this
+// update.
+static void note(search_cspace_t *cs, int c)
+{
+    if (cs->stamp[c] != cs->update) {
+        cs->stamp[c] = cs->update;
+        cs->was[c] = blocked(cs, c);
+        cs->changed[cs->changed_count++] = c;
+    }
+}
+
+namespace {
+
+// The wave's queue order, lowest key first, and positions, for
+// search_heap.h.
+struct cspace_heap_ops {
+    search_cspace_t *cs;
+
+    bool less(int a, int b) const
+    {
+        return cs->key[a] < cs->key[b];
+    }
+
+    int index(int c) const
+    {
+        return cs->heap_index[c];
+    }
+
+    void place(int c, int i) const
+    {
+        cs->heap_index[c] = i;
+    }
+};
+
+cspace_heap_ops ops(search_cspace_t *cs)
+{
+    const cspace_heap_ops o = { cs };
+    return o;
+}
+
+}
+
+// Queue a cell with the given key, or rekey it if it's already queued.
+static void heap_push(search_cspace_t *cs, int c, int key)
+{
+    cs->key[c] = key;
+    search_heap_update(cs->heap, &cs->heap_count, c, ops(cs));
+}
+
+// Forget a cell's nearest obstacle.
+static void forget(search_cspace_t *cs, int c)
+{
+    note(cs, c);
+    cs->nearest[c] = -1;
+    cs->distance[c] = infinity;
+}
+
+// Run the wave until the queue is empty. Raised cells clear any neighbor
+// whose nearest obstacle is gone, and queue the rest so they can lower into
+// the cleared cells. Lowered cells offer their nearest obstacle to their
+// neighbors.
+static void propagate(search_cspace_t *cs)
+{
+    search_map_t *map = cs->map;
+    while (cs->heap_count) {
+        const int c = search_heap_pop(cs->heap, &cs->heap_count, ops(cs));
+        const int x = c%map->dim_x, y = c/map->dim_x;
+        const int raise = cs->raise[c];
+        const int nearest = cs->nearest[c];
+        if (!raise && ((nearest < 0) || !cs->obstacle[nearest])) {
+            continue;
+        }
+        for (int m = 0; m < 8; ++m) {
+            const int nx = x + moves[m][0];
+            const int ny = y + moves[m][1];
+            if ((nx < 0) || (nx >= map->dim_x) || (ny < 0) || (ny >= map->dim_y)) {
+                continue;
+            }
+            const int n = nx + (map->dim_x*ny);
+            if (cs->raise[n]) {
+                continue;
+            }
+            if (raise) {
+                if (cs->nearest[n] < 0) {
+                    continue;
+                }
+                if (!cs->obstacle[cs->nearest[n]]) {
+                    const int key = cs->distance[n];
+                    forget(cs, n);
+                    cs->raise[n] = 1;
+                    heap_push(cs, n, key);
+                } else {
+                    heap_push(cs, n, cs->distance[n]);
+                }
+            } else {
+                const int d = distance2(map, nearest, n);
+                if ((d <= cs->limit) && (d < cs->distance[n])) {
+                    note(cs, n);
+                    cs->distance[n] = d;
+                    cs->nearest[n] = nearest;
+                    heap_push(cs, n, d);
+                }
+            }
+        }
+        cs->raise[c] = 0;
+    }
+}
+
+// Send the map every noted cell whose blocked state ended up different, and
+// start a fresh update.
+static int flush(search_cspace_t *cs)
+{
+    int count = 0;
+    for (int i = 0; i < cs->changed_count; ++i) {
+        const int c = cs->changed[i];
+        const int now = blocked(cs, c);
+        if (now != cs->was[c]) {
+            if (cs->apply) {
+                cs->apply(cs->apply_context, &cs->map->cells[c], now);
+            } else {
+                search_map_set_blocked(cs->map, &cs->map->cells[c], now);
+            }
+            ++count;
+        }
+    }
+    cs->changed_count = 0;
+    if (!++cs->update) {
+        const int cells = cs->map->dim_x*cs->map->dim_y;
+        for (int c = 0; c < cells; ++c) {
+            cs->stamp[c] = 0;
+        }
+        cs->update = 1;
+    }
+    return count;
+}
+
+int search_cspace_alloc(search_cspace_t *cspace, search_map_t *map,
+        int radius)
+{
+    const int cells = map->dim_x*map->dim_y;
+    cspace->map = map;
+    cspace->radius = radius;
+    cspace->limit = (radius+1)*(radius+1);
+    cspace->obstacle = (unsigned char*)malloc(cells);
+    cspace->nearest = (int*)malloc(sizeof(int)*cells);
+    cspace->distance = (int*)malloc(sizeof(int)*cells);
+    cspace->heap = (int*)malloc(sizeof(int)*cells);
+    cspace->heap_index = (int*)malloc(sizeof(int)*cells);
+    cspace->key = (int*)malloc(sizeof(int)*cells);
+    cspace->raise = (unsigned char*)malloc(cells);
+    cspace->changed = (int*)malloc(sizeof(int)*cells);
+    cspace->was = (unsigned char*)malloc(cells);
+    cspace->stamp = (unsigned*)malloc(sizeof(unsigned)*cells);
+    cspace->apply = 0;
+    cspace->apply_context = 0;
+    if (!cspace->obstacle || !cspace->nearest || !cspace->distance ||
+            !cspace->heap || !cspace->heap_index || !cspace->key ||
+            !cspace->raise || !cspace->changed || !cspace->was ||
+            !cspace->stamp) {
+        std::cout << "malloc failed" << std::endl;
+        search_cspace_free(cspace);
+        return 1;
+    }
+    search_cspace_clear(cspace);
+    return 0;
+}
+
+void search_cspace_clear(search_cspace_t *cspace)
+{
+    const int cells = cspace->map->dim_x*cspace->map->dim_y;
+    for (int c = 0; c < cells; ++c) {
+        cspace->obstacle[c] = 0;
+        cspace->nearest[c] = -1;
+        cspace->distance[c] = infinity;
+        cspace->heap_index[c] = -1;
+        cspace->raise[c] = 0;
+        cspace->stamp[c] = 0;
+    }
+    cspace->heap_count = 0;
+    cspace->changed_count = 0;
+    cspace->update = 1;
+    cspace->exempt[0] = cspace->exempt[1] = -1;
+}
+
+int search_cspace_set(search_cspace_t *cspace, int x, int y, int obstacle)
+{
+    const int c = x + (cspace->map->dim_x*y);
+    if (!cspace->obstacle[c] == !obstacle) {
+        return 0;
+    }
+    note(cspace, c);
+    if (obstacle) {
+        cspace->obstacle[c] = 1;
+        cspace->nearest[c] = c;
+        cspace->distance[c] = 0;
+        heap_push(cspace, c, 0);
+    } else {
+        cspace->obstacle[c] = 0;
+        forget(cspace, c);
+        cspace->raise[c] = 1;
+        heap_push(cspace, c, 0);
+    }
+    propagate(cspace);
+    return flush(cspace);
+}
+
+int search_cspace_exempt(search_cspace_t *cspace, search_cell_t *a,
+        search_cell_t *b)
+{
+    search_map_t *map = cspace->map;
+    const int next[2] = {
+        a ? (int)(a - map->cells) : -1,
+        b ? (int)(b - map->cells) : -1,
+    };
+    for (int i = 0; i < 2; ++i) {
+        if (cspace->exempt[i] >= 0) {
+            note(cspace, cspace->exempt[i]);
+        }
+        if (next[i] >= 0) {
+            note(cspace, next[i]);
+        }
+    }
+    cspace->exempt[0] = next[0];
+    cspace->exempt[1] = next[1];
+    return flush(cspace);
+}
+
+int search_cspace_clearance(const search_cspace_t *cspace, int x, int y)
+{
+    const int d = cspace->distance[x + (cspace->map->dim_x*y)];
+    return (d == infinity) ? -1 : d;
+}
+
+void search_cspace_free(search_cspace_t *cspace)
+{
+    free(cspace->obstacle);
+    free(cspace->nearest);
+    free(cspace->distance);
+    free(cspace->heap);
+    free(cspace->heap_index);
+    free(cspace->key);
+    free(cspace->raise);
+    free(cspace->changed);
+    free(cspace->was);
+    free(cspace->stamp);
+    cspace->obstacle = cspace->raise = cspace->was = 0;
+    cspace->nearest = cspace->distance = cspace->heap = 0;
+    cspace->heap_index = cspace->key = cspace->changed = 0;
+    cspace->stamp = 0;
+    cspace->heap_count = cspace->changed_count = 0;
+}
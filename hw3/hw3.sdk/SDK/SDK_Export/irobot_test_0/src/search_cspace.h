@@ -0,0 +1,93 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_cspace_h_
+#define _search_cspace_h_
+
+#include "search.h"
+
+// A configuration space layer over a search map. Obstacles are reported to
+// the layer rather than set on the map. The layer keeps each cell's
+// clearance, the distance to its nearest obstacle, and blocks every map cell
+// within radius of an obstacle, so planners that only look at the map's
+// blocked cells keep the robot's footprint clear of obstacles.
+//
+// Clearance is kept as a dynamic Euclidean distance map (after Lau et al.):
+// each cell remembers its nearest obstacle, and adding or removing an
+// obstacle sends a wave out only as far as the cells whose nearest obstacle
+// changes. Distances are squared, in cells. Only inflation needs them, so
+// clearance is tracked just one cell past the radius; the wave goes no
+// farther, and each update stays local to the obstacle.
+//
+// A couple of cells can be exempted from inflation: the cell the robot stands
+// on and the goal it's headed for. Otherwise an obstacle the robot has just
+// found would block the robot in.
+//
+// All per cell state is indexed by the cell's position in map->cells.
+
+// Apply a change to the map, for instance through search_update_cell so an
+// incremental planner hears of it.
+typedef void (*search_cspace_apply_t)(void *context, search_cell_t *c,
+        int blocked);
+
+typedef struct {
+    search_map_t *map;
+
+    // cells whose squared clearance is at most radius*radius are blocked.
+    // Squared clearance beyond limit isn't tracked.
+    int radius;
+    int limit;
+
+    // whether each cell is an obstacle, and each cell's nearest obstacle
+    // (-1 if none) and squared distance to it.
+    unsigned char *obstacle;
+    int *nearest, *distance;
+
+    // the wavefront, a binary min-heap of cell indices ordered by key. Cells
+    // marked raise lost their nearest obstacle and are being cleared.
+    int *heap, heap_count;
+    int *heap_index;
+    int *key;
+    unsigned char *raise;
+
+    // the cells exempt from inflation, -1 if none.
+    int exempt[2];
+
+    // the cells whose clearance changed during an update, and whether each
+    // was blocked before it.
+    int *changed, changed_count;
+    unsigned char *was;
+    unsigned *stamp, update;
+
+    // where blocked changes are sent; null for search_map_set_blocked.
+    search_cspace_apply_t apply;
+    void *apply_context;
+} search_cspace_t;
+
+// Allocate the layer for the map from the heap. The layer starts with no
+// obstacles, and applies its changes with search_map_set_blocked.
+// Returns zero on success, non-zero on failure.
+int search_cspace_alloc(search_cspace_t *cspace, search_map_t *map,
+        int radius);
+
+// Forget every obstacle and exemption. This doesn't touch the map; use it
+// alongside search_map_initialize(map, 1).
+void search_cspace_clear(search_cspace_t *cspace);
+
+// Mark x,y as an obstacle, or not, and block or unblock the map cells whose
+// inflation changed as a result.
+// Returns the number of map cells changed.
+int search_cspace_set(search_cspace_t *cspace, int x, int y, int obstacle);
+
+// Exempt up to two cells from inflation, replacing any earlier exemption.
+// Either may be null. An exempt cell is still blocked if it's an obstacle.
+// Returns the number of map cells changed.
+int search_cspace_exempt(search_cspace_t *cspace, search_cell_t *a,
+        search_cell_t *b);
+
+// Return the squared distance from x,y to the nearest obstacle in cells, or
+// -1 if there are no obstacles within (radius+1) cells.
+int search_cspace_clearance(const search_cspace_t *cspace, int x, int y);
+
+// Free any dynamic memory associated with the layer.
+void search_cspace_free(search_cspace_t *cspace);
+#endif
@@ -0,0 +1,361 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#include <iostream>
+#include <cstdlib>
+#include <limits>
+
+extern "C" {
+#include "search_dstar.h"
+}
+#include "search_heap.h"
+
+// Unreachable. Small enough that adding path costs can't overflow.
+static const int infinity = std::numeric_limits<int>::max()/4;
+
+// The cell delta of driving along each heading.
+static const int moves[][2] = {{-1,0},{0,1},{1,0},{0,-1}};
+
+// The distance heuristic between two states: the cost of driving the cells
+// between them, ignoring turns, so it never overestimates.
+static int h_distance(const search_dstar_t *d, int a, int b)
+{
+    const search_cell_t *ca = &d->map->cells[a>>2];
+    const search_cell_t *cb = &d->map->cells[b>>2];
+    return d->step_cost*(std::abs(ca->x-cb->x) + std::abs(ca->y-cb->y));
+}
+
+// Return the index of the neighbor of cell i along heading h, or -1 if it's
+// off the map.
+static int neighbor(const search_map_t *map, int i, int h)
+{
+    const int x = map->cells[i].x + moves[h][0];
+    const int y = map->cells[i].y + moves[h][1];
+    if ((x < 0) || (y < 0) || (x >= map->dim_x) || (y >= map->dim_y)) {
+        return -1;
+    }
+    return x + (map->dim_x*y);
+}
+
+// The cost of driving between adjacent cells.
+static int cost(const search_dstar_t *d, int a, int b)
+{
+    if (d->map->cells[a].blocked || d->map->cells[b].blocked) {
+        return infinity;
+    }
+    return d->step_cost;
+}
+
+// The cost of turning from heading a to heading b the short way.
+static int turn_cost(const search_dstar_t *d, int a, int b)
+{
+    const int q = (b-a) & 3;
+    return d->turn_cost*((q == 3) ? 1 : q);
+}
+
+// The cost of what's left once a state reaches the goal cell: turning to the
+// goal heading.
+static int goal_cost(const search_dstar_t *d, int s)
+{
+    if (d->goal_heading == search_heading_any) {
+        return 0;
+    }
+    return turn_cost(d, s&3, d->goal_heading);
+}
+
+// Key ordering.
+static bool key_less(const search_dstar_t *d, int a, int b)
+{
+    if (d->key1[a] != d->key1[b]) {
+        return d->key1[a] < d->key1[b];
+    }
+    return d->key2[a] < d->key2[b];
+}
+
+namespace {
+
+// The open list's order and positions, for search_heap.h.
+struct dstar_heap_ops {
+    search_dstar_t *d;
+
+    bool less(int a, int b) const
+    {
+        return key_less(d, a, b);
+    }
+
+    int index(int c) const
+    {
+        return d->heap_index[c];
+    }
+
+    void place(int c, int i) const
+    {
+        d->heap_index[c] = i;
+    }
+};
+
+dstar_heap_ops ops(search_dstar_t *d)
+{
+    const dstar_heap_ops o = { d };
+    return o;
+}
+
+}
+
+static void heap_remove(search_dstar_t *d, int c)
+{
+    search_heap_remove(d->heap, &d->heap_count, c, ops(d));
+    search_stats_pop(d->map->stats);
+}
+
+// Insert or reposition a cell with the given key.
+static void heap_update(search_dstar_t *d, int c, int k1, int k2)
+{
+    d->key1[c] = k1;
+    d->key2[c] = k2;
+    if (d->heap_index[c] < 0) {
+        search_stats_push(d->map->stats, d->heap_count+1);
+    } else {
+        search_stats_decrease(d->map->stats);
+    }
+    search_heap_update(d->heap, &d->heap_count, c, ops(d));
+}
+
+// Calculate the key of a state relative to the current start.
+static void calculate_key(const search_dstar_t *d, int s, int *k1, int *k2)
+{
+    const int m = std::min(d->g[s], d->rhs[s]);
+    *k1 = (m >= infinity) ? infinity : (m + h_distance(d, d->last, s) + d->km);
+    *k2 = m;
+}
+
+// The cost of the best way on from a state: turning to a heading, if need
+// be, and driving one cell along it.
+static int lookahead(const search_dstar_t *d, int s)
+{
+    int best = infinity;
+    for (int h = 0; h < 4; ++h) {
+        const int n = neighbor(d->map, s>>2, h);
+        if (n >= 0) {
+            best = std::min(best, turn_cost(d, s&3, h) + cost(d, s>>2, n)
+                    + d->g[(4*n)+h]);
+        }
+    }
+    return std::min(best, infinity);
+}
+
+// Recompute the lookahead of a state and queue it if it's inconsistent.
+static void update_vertex(search_dstar_t *d, int s)
+{
+    if ((s>>2) != d->goal) {
+        d->rhs[s] = lookahead(d, s);
+    }
+    if (d->g[s] != d->rhs[s]) {
+        int k1, k2;
+        calculate_key(d, s, &k1, &k2);
+        heap_update(d, s, k1, k2);
+    } else if (d->heap_index[s] >= 0) {
+        heap_remove(d, s);
+    }
+}
+
+// Queue the states that lead into s for repair: those of the cell behind
+// it, which reach s by driving along its heading.
+static void update_predecessors(search_dstar_t *d, int s)
+{
+    const int p = neighbor(d->map, s>>2, (s+2)&3);
+    if (p >= 0) {
+        for (int h = 0; h < 4; ++h) {
+            update_vertex(d, (4*p)+h);
+        }
+    }
+}
+
+// Process the open list until the start is consistent.
+static void compute_shortest_path(search_dstar_t *d)
+{
+    const int start = d->last;
+    for (;;) {
+        int k1, k2;
+        calculate_key(d, start, &k1, &k2);
+        if (!d->heap_count) {
+            break;
+        }
+        const int u = d->heap[0];
+        search_stats_expand(d->map->stats, 1);
+        const bool top_less = (d->key1[u] < k1) ||
+            ((d->key1[u] == k1) && (d->key2[u] < k2));
+        if (!top_less && (d->rhs[start] == d->g[start])) {
+            break;
+        }
+
+        int new1, new2;
+        calculate_key(d, u, &new1, &new2);
+        if ((d->key1[u] < new1) || ((d->key1[u] == new1) && (d->key2[u] < new2))) {
+            heap_update(d, u, new1, new2);
+        } else if (d->g[u] > d->rhs[u]) {
+            d->g[u] = d->rhs[u];
+            heap_remove(d, u);
+            update_predecessors(d, u);
+        } else {
+            d->g[u] = infinity;
+            update_vertex(d, u);
+            update_predecessors(d, u);
+        }
+    }
+}
+
+int search_dstar_alloc(search_dstar_t *dstar, search_map_t *map,
+        int step_cost, int turn_cost)
+{
+    const int states = 4*map->dim_x*map->dim_y;
+    dstar->map = map;
+    dstar->step_cost = step_cost;
+    dstar->turn_cost = turn_cost;
+    dstar->g = (int*)malloc(sizeof(int)*states);
+    dstar->rhs = (int*)malloc(sizeof(int)*states);
+    dstar->heap = (int*)malloc(sizeof(int)*states);
+    dstar->heap_index = (int*)malloc(sizeof(int)*states);
+    dstar->key1 = (int*)malloc(sizeof(int)*states);
+    dstar->key2 = (int*)malloc(sizeof(int)*states);
+    dstar->heap_count = 0;
+    dstar->goal = -1;
+    if (!dstar->g || !dstar->rhs || !dstar->heap || !dstar->heap_index ||
+            !dstar->key1 || !dstar->key2) {
+        std::cout << "malloc failed" << std::endl;
+        search_dstar_free(dstar);
+        return 1;
+    }
+    return 0;
+}
+
+void search_dstar_free(search_dstar_t *dstar)
+{
+    free(dstar->g);
+    free(dstar->rhs);
+    free(dstar->heap);
+    free(dstar->heap_index);
+    free(dstar->key1);
+    free(dstar->key2);
+    dstar->g = dstar->rhs = dstar->heap = dstar->heap_index = 0;
+    dstar->key1 = dstar->key2 = 0;
+    dstar->heap_count = 0;
+    dstar->goal = -1;
+}
+
+void search_dstar_initialize(search_dstar_t *dstar, search_cell_t *start,
+        int start_heading, search_cell_t *goal, int goal_heading)
+{
+    search_map_t *map = dstar->map;
+    const int states = 4*map->dim_x*map->dim_y;
+    for (int s = 0; s < states; ++s) {
+        dstar->g[s] = infinity;
+        dstar->rhs[s] = infinity;
+        dstar->heap_index[s] = -1;
+    }
+    dstar->heap_count = 0;
+    dstar->km = 0;
+    dstar->goal = goal - map->cells;
+    dstar->goal_heading = goal_heading;
+    dstar->last = (4*(start - map->cells)) + start_heading;
+    for (int h = 0; h < 4; ++h) {
+        const int s = (4*dstar->goal) + h;
+        dstar->rhs[s] = goal_cost(dstar, s);
+        heap_update(dstar, s, dstar->rhs[s] + h_distance(dstar, dstar->last, s),
+                dstar->rhs[s]);
+    }
+}
+
+void search_update_cell(search_dstar_t *dstar, search_cell_t *c, int blocked)
+{
+    if (c->blocked == blocked) {
+        return;
+    }
+    search_map_set_blocked(dstar->map, c, blocked);
+    if (dstar->goal < 0) {
+        return;
+    }
+
+    // The drives into and out of the cell changed cost, which affects the
+    // lookahead of each of the cell's states, and of each state of its
+    // neighbors.
+    const int i = c - dstar->map->cells;
+    if (blocked) {
+        for (int h = 0; h < 4; ++h) {
+            dstar->g[(4*i)+h] = infinity;
+        }
+    }
+    for (int h = 0; h < 4; ++h) {
+        update_vertex(dstar, (4*i)+h);
+    }
+    for (int m = 0; m < 4; ++m) {
+        const int n = neighbor(dstar->map, i, m);
+        if (n < 0) {
+            continue;
+        }
+        for (int h = 0; h < 4; ++h) {
+            update_vertex(dstar, (4*n)+h);
+        }
+    }
+}
+
+// Repair the plan for the new start and thread the path.
+static int find(search_dstar_t *dstar, search_cell_t *start, int start_heading)
+{
+    search_map_t *map = dstar->map;
+
+    // Moving the start lowers every queued key by at most the distance moved,
+    // so fold that into the key modifier rather than rekeying the open list.
+    int s = (4*(start - map->cells)) + start_heading;
+    dstar->km += h_distance(dstar, dstar->last, s);
+    dstar->last = s;
+    compute_shortest_path(dstar);
+
+    if (dstar->g[s] >= infinity) {
+        return 1;
+    }
+
+    // Thread the path by walking downhill from the start, exactly as
+    // search_find would have left it. Each step turns to the best heading,
+    // if need be, and drives one cell. Once on the goal cell, only turns in
+    // place are left, and those don't add cells.
+    int steps = map->dim_x*map->dim_y;
+    start->prev = 0;
+    int c = s>>2;
+    while (c != dstar->goal) {
+        if (!steps--) {
+            return 1;
+        }
+        int best = -1;
+        int best_cost = infinity;
+        for (int h = 0; h < 4; ++h) {
+            const int n = neighbor(map, c, h);
+            if (n < 0) {
+                continue;
+            }
+            const int v = turn_cost(dstar, s&3, h) + cost(dstar, c, n)
+                + dstar->g[(4*n)+h];
+            if (v < best_cost) {
+                best_cost = v;
+                best = (4*n)+h;
+            }
+        }
+        if (best_cost >= infinity) {
+            return 1;
+        }
+        map->cells[c].next = &map->cells[best>>2];
+        map->cells[best>>2].prev = &map->cells[c];
+        s = best;
+        c = s>>2;
+    }
+    map->cells[c].next = 0;
+    return 0;
+}
+
+int search_dstar_find(search_dstar_t *dstar, search_cell_t *start,
+        int start_heading)
+{
+    search_stats_begin(dstar->map->stats);
+    const int status = find(dstar, start, start_heading);
+    search_stats_end(dstar->map->stats, !status);
+    return status;
+}
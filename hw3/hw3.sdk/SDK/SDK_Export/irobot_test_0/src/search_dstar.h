@@ -0,0 +1,69 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_dstar_h_
+#define _search_dstar_h_
+
+#include "search.h"
+#include "search_lattice.h"
+
+// An incremental planner (D* Lite) over a search map. The planner searches
+// backward from the goal and keeps its g and rhs values between calls, so
+// when a cell's blocked state changes only the affected region is repaired,
+// rather than replanning from scratch with search_find.
+//
+// Like search_lattice, it plans over (x, y, heading), so replans keep the
+// robot's turns in the bill. Each move turns in place to a heading, at the
+// turn cost per 90 degrees, and then drives one cell along it at the step
+// cost; once on the goal cell, the robot turns to the goal heading. Folding
+// turns into drives keeps every move's cost positive, as D* Lite needs, even
+// with a turn cost of zero, which plans the shortest path in cells.
+//
+// All per state arrays are indexed by (4 * cell index) + heading.
+typedef struct {
+    search_map_t *map;
+
+    // the cost of driving one cell, and of turning 90 degrees.
+    int step_cost, turn_cost;
+
+    // cost-to-goal estimate, and its one step lookahead.
+    int *g, *rhs;
+
+    // the open list, a binary min-heap of states ordered by key.
+    int *heap, heap_count;
+    int *heap_index;
+    int *key1, *key2;
+
+    // the key modifier, accumulated as the start moves.
+    int km;
+
+    // the goal cell and heading, and the start state the keys were last
+    // computed for. goal is -1 until the planner is initialized.
+    int goal, goal_heading, last;
+} search_dstar_t;
+
+// Allocate planner state for the map from the heap, with the given costs.
+// The step cost must be positive; the turn cost may be zero.
+// Returns zero on success, non-zero on failure.
+int search_dstar_alloc(search_dstar_t *dstar, search_map_t *map,
+        int step_cost, int turn_cost);
+
+// Start planning from start, facing start_heading, to goal, ending with
+// goal_heading (or search_heading_any), discarding any previous plan. The
+// next search_dstar_find does a full search.
+void search_dstar_initialize(search_dstar_t *dstar, search_cell_t *start,
+        int start_heading, search_cell_t *goal, int goal_heading);
+
+// Set the blocked state of a cell. If the planner is initialized, the cell
+// and its neighbors are queued for repair by the next search_dstar_find.
+void search_update_cell(search_dstar_t *dstar, search_cell_t *c, int blocked);
+
+// Find the goal from start, facing start_heading, either of which may have
+// changed since the last call. On success the path is threaded through the
+// cells' prev and next fields, just like search_find.
+// Returns zero on success, non-zero if the goal can't be reached.
+int search_dstar_find(search_dstar_t *dstar, search_cell_t *start,
+        int start_heading);
+
+// Free any dynamic memory associated with the planner.
+void search_dstar_free(search_dstar_t *dstar);
+#endif
@@ -0,0 +1,267 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SEARCH_FIELD_NEON
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define SEARCH_FIELD_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SEARCH_FIELD_SSE2
+#endif
+
+extern "C" {
+#include "search_field.h"
+}
+
+// Rows are padded to a multiple of the widest vector (16 lanes of 16 bits),
+// and the padding is marked blocked, so the vector loops need no tail.
+static const int lanes = 16;
+
+static const int moves[][2] = {{-1,0},{1,0},{0,-1},{0,1}};
+
+static uint16_t* row(const search_field_t *field, uint16_t *base, int y)
+{
+    return &base[field->stride*y];
+}
+
+// Relax a row against its neighbor row: d = min(d, n+1), then force the
+// blocked cells back to unreached.
+static void relax_row(uint16_t *d, const uint16_t *n, const uint16_t *blocked,
+        int stride)
+{
+#if defined(SEARCH_FIELD_NEON)
+    const uint16x8_t one = vdupq_n_u16(1);
+    for (int x = 0; x < stride; x += 8) {
+        uint16x8_t v = vminq_u16(vld1q_u16(d+x), vqaddq_u16(vld1q_u16(n+x), one));
+        vst1q_u16(d+x, vorrq_u16(v, vld1q_u16(blocked+x)));
+    }
+#elif defined(SEARCH_FIELD_AVX2)
+    const __m256i one = _mm256_set1_epi16(1);
+    for (int x = 0; x < stride; x += 16) {
+        const __m256i a = _mm256_loadu_si256((const __m256i*)(d+x));
+        const __m256i b = _mm256_adds_epu16(
+                _mm256_loadu_si256((const __m256i*)(n+x)), one);
+        const __m256i m = _mm256_loadu_si256((const __m256i*)(blocked+x));
+        _mm256_storeu_si256((__m256i*)(d+x),
+                _mm256_or_si256(_mm256_min_epu16(a, b), m));
+    }
+#elif defined(SEARCH_FIELD_SSE2)
+    // SSE2 has no unsigned 16-bit min, but a - sat(a-b) is min(a,b).
+    const __m128i one = _mm_set1_epi16(1);
+    for (int x = 0; x < stride; x += 8) {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(d+x));
+        const __m128i b = _mm_adds_epu16(
+                _mm_loadu_si128((const __m128i*)(n+x)), one);
+        const __m128i m = _mm_loadu_si128((const __m128i*)(blocked+x));
+        const __m128i v = _mm_sub_epi16(a, _mm_subs_epu16(a, b));
+        _mm_storeu_si128((__m128i*)(d+x), _mm_or_si128(v, m));
+    }
+#else
+    for (int x = 0; x < stride; ++x) {
+        const int v = n[x] + 1;
+        if (v < d[x]) {
+            d[x] = v;
+        }
+        d[x] |= blocked[x];
+    }
+#endif
+}
+
+// Carry distances along a row left to right and back. Each step depends on
+// the last, so this part stays scalar, but it's kept branch free: a blocked
+// cell's mask forces whatever it's offered back to unreached. Returns
+// non-zero if anything in the row got closer.
+static int sweep_row(uint16_t *d, const uint16_t *blocked, int dim_x,
+        uint64_t *sum)
+{
+    for (int x = 1; x < dim_x; ++x) {
+        const int v = std::min(d[x-1]+1, 0xffff) | blocked[x];
+        d[x] = std::min((int)d[x], v);
+    }
+    uint64_t total = d[dim_x-1];
+    for (int x = dim_x-2; x >= 0; --x) {
+        const int v = std::min(d[x+1]+1, 0xffff) | blocked[x];
+        d[x] = std::min((int)d[x], v);
+        total += d[x];
+    }
+    const int changed = (total != *sum);
+    *sum = total;
+    return changed;
+}
+
+// Relax row j against row n if either has changed since j was last swept.
+static void update_row(search_field_t *field, int j, int n, unsigned *clock)
+{
+    const int has_n = (n >= 0) && (n < field->dim_y);
+    const unsigned seen = field->seen[j];
+    if ((field->changed[j] <= seen) && (!has_n || (field->changed[n] <= seen))) {
+        return;
+    }
+    uint16_t *d = row(field, field->distance, j);
+    const uint16_t *b = row(field, field->blocked, j);
+    if (has_n) {
+        relax_row(d, row(field, field->distance, n), b, field->stride);
+    }
+    field->seen[j] = ++*clock;
+    if (sweep_row(d, b, field->dim_x, &field->sum[j])) {
+        field->changed[j] = *clock;
+    }
+}
+
+// Return non-zero if any row changed after the given time.
+static int changed_since(const search_field_t *field, unsigned start)
+{
+    for (int j = 0; j < field->dim_y; ++j) {
+        if (field->changed[j] > start) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int search_field_alloc(search_field_t *field, int dim_x, int dim_y)
+{
+    field->dim_x = dim_x;
+    field->dim_y = dim_y;
+    field->stride = ((dim_x+lanes-1)/lanes)*lanes;
+    field->origin_x = field->origin_y = -1;
+    const int size = field->stride*dim_y;
+    field->distance = (uint16_t*)malloc(sizeof(uint16_t)*size);
+    field->blocked = (uint16_t*)malloc(sizeof(uint16_t)*size);
+    field->sum = (uint64_t*)malloc(sizeof(uint64_t)*dim_y);
+    field->seen = (unsigned*)malloc(sizeof(unsigned)*dim_y);
+    field->changed = (unsigned*)malloc(sizeof(unsigned)*dim_y);
+    if (!field->distance || !field->blocked || !field->sum || !field->seen ||
+            !field->changed) {
+        std::cout << "malloc failed" << std::endl;
+        search_field_free(field);
+        return 1;
+    }
+    return 0;
+}
+
+void search_field_free(search_field_t *field)
+{
+    free(field->distance);
+    free(field->blocked);
+    free(field->sum);
+    free(field->seen);
+    free(field->changed);
+    field->distance = field->blocked = 0;
+    field->sum = 0;
+    field->seen = field->changed = 0;
+    field->dim_x = field->dim_y = field->stride = 0;
+}
+
+// Compute the field from x,y, returning the number of row sweeps it took, or
+// -1 if x,y is blocked.
+static int fill(search_field_t *field, search_map_t *map, int x, int y)
+{
+    const int size = field->stride*field->dim_y;
+    field->origin_x = x;
+    field->origin_y = y;
+
+    // Expand the bitboard into lane masks. Padding past the last word of a
+    // bitboard row is blocked too.
+    const search_bits_t *bits = &map->bits;
+    for (int j = 0; j < field->dim_y; ++j) {
+        uint16_t *b = row(field, field->blocked, j);
+        const uint64_t *r = &bits->rows[bits->words*j];
+        for (int i = 0; i < field->stride; ++i) {
+            const int w = i >> 6;
+            b[i] = ((w >= bits->words) || ((r[w] >> (i&63)) & 1)) ? 0xffff : 0;
+        }
+    }
+    memset(field->distance, 0xff, sizeof(uint16_t)*size);
+    for (int j = 0; j < field->dim_y; ++j) {
+        field->sum[j] = (uint64_t)0xffff*field->dim_x;
+        field->seen[j] = field->changed[j] = 0;
+    }
+    if (search_bits_test(bits, x, y)) {
+        return -1;
+    }
+    row(field, field->distance, y)[x] = 0;
+
+    // Sweep down and back up until no row changes. Like the flood fill, the
+    // number of sweeps follows the number of turns, not the area. Each row
+    // remembers when it last changed and when it was last swept, so rows
+    // whose neighbors have settled are skipped.
+    unsigned clock = 1;
+    field->changed[y] = clock;
+    for (;;) {
+        const unsigned start = clock;
+        for (int j = 0; j < field->dim_y; ++j) {
+            update_row(field, j, j-1, &clock);
+        }
+        for (int j = field->dim_y-1; j >= 0; --j) {
+            update_row(field, j, j+1, &clock);
+        }
+        if (!changed_since(field, start)) {
+            break;
+        }
+    }
+    return clock-1;
+}
+
+void search_distance_field(search_field_t *field, search_map_t *map, int x,
+        int y)
+{
+    // There's no open list; count each swept row's cells as expanded.
+    search_stats_begin(map->stats);
+    const int sweeps = fill(field, map, x, y);
+    if (sweeps > 0) {
+        search_stats_expand(map->stats, sweeps*field->dim_x);
+    }
+    search_stats_end(map->stats, sweeps >= 0);
+}
+
+int search_field_distance(const search_field_t *field, int x, int y)
+{
+    if ((x < 0) || (y < 0) || (x >= field->dim_x) || (y >= field->dim_y)) {
+        return search_field_unreached;
+    }
+    return field->distance[(field->stride*y)+x];
+}
+
+int search_field_path(const search_field_t *field, search_map_t *map,
+        search_cell_t *goal)
+{
+    int x = goal->x;
+    int y = goal->y;
+    int d = search_field_distance(field, x, y);
+    if (d == search_field_unreached) {
+        return 1;
+    }
+
+    // Walk downhill from the goal; every reached cell but the origin has a
+    // neighbor exactly one step closer.
+    search_cell_t *c = goal;
+    c->next = 0;
+    while (d) {
+        int m = 0;
+        for (; m < 4; ++m) {
+            if (search_field_distance(field, x+moves[m][0], y+moves[m][1]) == (d-1)) {
+                break;
+            }
+        }
+        if (m == 4) {
+            return 1;
+        }
+        x += moves[m][0];
+        y += moves[m][1];
+        --d;
+        search_cell_t *p = search_cell_at(map, x, y);
+        c->prev = p;
+        p->next = c;
+        c = p;
+    }
+    c->prev = 0;
+    return 0;
+}
@@ -0,0 +1,61 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_field_h_
+#define _search_field_h_
+
+#include <stdint.h>
+#include "search.h"
+
+// A grid distance field: the number of steps from an origin cell to every
+// cell on the map. One field answers every goal at once, which suits
+// planning to many goals from the same place.
+//
+// The field is computed by sweeping rows down and back up until nothing
+// changes. Relaxing a row against the row above or below is vectorized
+// (NEON on the Cortex-A9 when built with -mfpu=neon, SSE2 or AVX2 on x86
+// hosts, scalar otherwise).
+#define search_field_unreached 0xffff
+
+typedef struct {
+    int dim_x, dim_y;
+
+    // row length in elements, rounded up to a whole number of vectors.
+    int stride;
+
+    // the distance to each cell, search_field_unreached if unreachable.
+    uint16_t *distance;
+
+    // 0xffff for each blocked cell (and the padding past dim_x), 0 otherwise.
+    uint16_t *blocked;
+
+    // per row sweep state: the sum of the row's distances, when the row
+    // was last swept, and when it last changed.
+    uint64_t *sum;
+    unsigned *seen, *changed;
+
+    // the cell the distances are measured from.
+    int origin_x, origin_y;
+} search_field_t;
+
+// Allocate a field for maps of the given dimensions.
+// Returns zero on success, non-zero on failure.
+int search_field_alloc(search_field_t *field, int dim_x, int dim_y);
+
+// Compute the distance from x,y to every cell of the map.
+void search_distance_field(search_field_t *field, search_map_t *map, int x,
+        int y);
+
+// Return the distance to x,y, or search_field_unreached. Distances past
+// 0xfffe saturate to unreached.
+int search_field_distance(const search_field_t *field, int x, int y);
+
+// Thread the path from the field's origin to the goal through the cells'
+// prev and next fields by walking downhill from the goal, just like
+// search_find leaves it.
+// Returns zero on success, non-zero if the goal can't be reached.
+int search_field_path(const search_field_t *field, search_map_t *map,
+        search_cell_t *goal);
+
+// Free any dynamic memory associated with the field.
+void search_field_free(search_field_t *field);
+#endif
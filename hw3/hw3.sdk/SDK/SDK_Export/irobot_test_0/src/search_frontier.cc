@@ -0,0 +1,241 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+#include "search_frontier.h"
+}
+
+static const int moves[][2] = {{-1,0},{0,1},{1,0},{0,-1}};
+
+// The order search_field_path tries downhill neighbors in.
+static const int field_moves[][2] = {{-1,0},{1,0},{0,-1},{0,1}};
+
+// Whether x,y is on the grid, with no evidence about it yet.
+static int frontier_unknown(const search_occupancy_t *o, int x, int y)
+{
+    return (x >= 0) && (y >= 0) && (x < o->dim_x) && (y < o->dim_y) &&
+        !search_occupancy_known(o, x, y);
+}
+
+// Whether x,y belongs on the frontier: unknown, not given up on, and next to
+// a known free cell.
+static int frontier_cell(const search_frontier_t *f, int x, int y)
+{
+    const search_occupancy_t *o = f->occupancy;
+    if (search_occupancy_known(o, x, y) || f->rejected[x + (o->dim_x*y)]) {
+        return 0;
+    }
+    for (int m = 0; m < 4; ++m) {
+        const int nx = x + moves[m][0];
+        const int ny = y + moves[m][1];
+        if (search_occupancy_known(o, nx, ny) &&
+                !search_occupancy_occupied(o, nx, ny)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Add x,y to the frontier or take it off, as it now deserves.
+static void frontier_refresh(search_frontier_t *f, int x, int y)
+{
+    const search_occupancy_t *o = f->occupancy;
+    if ((x < 0) || (y < 0) || (x >= o->dim_x) || (y >= o->dim_y)) {
+        return;
+    }
+    const int c = x + (o->dim_x*y);
+    const int member = frontier_cell(f, x, y);
+    if (member && (f->index[c] < 0)) {
+        f->index[c] = f->count;
+        f->cells[f->count++] = c;
+    } else if (!member && (f->index[c] >= 0)) {
+
+        // Move the last cell into the hole.
+        const int last = f->cells[--f->count];
+        f->cells[f->index[c]] = last;
+        f->index[last] = f->index[c];
+        f->index[c] = -1;
+    }
+}
+
+// A cell's knowledge or view changed, which can only affect it and its
+// neighbors. Once a cell given up on is known, it's no longer given up on.
+static void frontier_watch(void *context, int x, int y)
+{
+    search_frontier_t *f = (search_frontier_t*)context;
+    if (search_occupancy_known(f->occupancy, x, y)) {
+        f->rejected[x + (f->occupancy->dim_x*y)] = 0;
+    }
+    frontier_refresh(f, x, y);
+    for (int m = 0; m < 4; ++m) {
+        frontier_refresh(f, x + moves[m][0], y + moves[m][1]);
+    }
+}
+
+int search_frontier_alloc(search_frontier_t *frontier,
+        search_occupancy_t *occupancy)
+{
+    const int cells = occupancy->dim_x*occupancy->dim_y;
+    frontier->occupancy = occupancy;
+    frontier->cells = (int*)malloc(sizeof(int)*cells);
+    frontier->index = (int*)malloc(sizeof(int)*cells);
+    frontier->rejected = (unsigned char*)malloc(cells);
+    if (!frontier->cells || !frontier->index || !frontier->rejected) {
+        std::cout << "malloc failed" << std::endl;
+        search_frontier_free(frontier);
+        return 1;
+    }
+    occupancy->watch = frontier_watch;
+    occupancy->watch_context = frontier;
+    search_frontier_rebuild(frontier);
+    return 0;
+}
+
+void search_frontier_rebuild(search_frontier_t *frontier)
+{
+    const search_occupancy_t *o = frontier->occupancy;
+    const int cells = o->dim_x*o->dim_y;
+    memset(frontier->rejected, 0, cells);
+    frontier->count = 0;
+    for (int c = 0; c < cells; ++c) {
+        frontier->index[c] = -1;
+    }
+    for (int c = 0; c < cells; ++c) {
+        frontier_refresh(frontier, c%o->dim_x, c/o->dim_x);
+    }
+}
+
+void search_frontier_reject(search_frontier_t *frontier, int x, int y)
+{
+    const search_occupancy_t *o = frontier->occupancy;
+    if ((x < 0) || (y < 0) || (x >= o->dim_x) || (y >= o->dim_y) ||
+            search_occupancy_known(o, x, y)) {
+        return;
+    }
+    frontier->rejected[x + (o->dim_x*y)] = 1;
+    frontier_refresh(frontier, x, y);
+}
+
+// Estimate what driving from the field's origin to x,y would turn up, and
+// how many turns it would take, following the same downhill walk as
+// search_field_path. Every unknown cell driven through becomes known, and so
+// does every unknown cell the wall sensor passes on the right. Also return
+// the direction the robot arrives in.
+static void frontier_estimate(const search_frontier_t *f,
+        const search_field_t *field, int x, int y, int *gain, int *turns,
+        int *arrive_x, int *arrive_y)
+{
+    const search_occupancy_t *o = f->occupancy;
+    int d = search_field_distance(field, x, y);
+    int last_dx = 0, last_dy = 0;
+    *gain = 0;
+    *turns = 0;
+    *arrive_x = *arrive_y = 0;
+    while (d) {
+        if (frontier_unknown(o, x, y)) {
+            ++*gain;
+        }
+        int m = 0;
+        for (; m < 4; ++m) {
+            if (search_field_distance(field, x+field_moves[m][0],
+                        y+field_moves[m][1]) == (d-1)) {
+                break;
+            }
+        }
+        if (m == 4) {
+            return;
+        }
+
+        // We drive from the neighbor into x,y.
+        const int dx = -field_moves[m][0], dy = -field_moves[m][1];
+        if (!last_dx && !last_dy) {
+            *arrive_x = dx;
+            *arrive_y = dy;
+        } else if ((dx != last_dx) || (dy != last_dy)) {
+            ++*turns;
+        }
+        last_dx = dx;
+        last_dy = dy;
+        x -= dx;
+        y -= dy;
+        --d;
+        if (frontier_unknown(o, x+dy, y-dx)) {
+            ++*gain;
+        }
+    }
+}
+
+int search_frontier_pick(const search_frontier_t *frontier,
+        const search_field_t *field, int cell_ms, int turn_ms, int *x,
+        int *y)
+{
+    const search_occupancy_t *o = frontier->occupancy;
+    int best_x = -1, best_y = -1;
+    uint64_t best_gain = 0, best_cost = 1;
+    for (int i = 0; i < frontier->count; ++i) {
+        const int c = frontier->cells[i];
+        int cx = c%o->dim_x, cy = c/o->dim_x;
+        int d = search_field_distance(field, cx, cy);
+        if ((d == search_field_unreached) || !d) {
+            continue;
+        }
+
+        // Every move turns to face its first run and back again at the end.
+        int gain, turns, dx, dy;
+        frontier_estimate(frontier, field, cx, cy, &gain, &turns, &dx, &dy);
+        uint64_t cost = ((uint64_t)d*cell_ms) + ((uint64_t)(turns+2)*turn_ms);
+
+        // Consider driving straight on past the frontier cell, into the
+        // unknown, since carrying on costs no more turns, but not into cells
+        // given up on. Compare gain/cost by cross multiplying, preferring the
+        // nearer goal on a tie.
+        for (;;) {
+            const uint64_t better = (uint64_t)gain*best_cost;
+            const uint64_t worse = best_gain*cost;
+            if ((best_x < 0) || (better > worse) ||
+                    ((better == worse) && (cost < best_cost))) {
+                best_x = cx;
+                best_y = cy;
+                best_gain = gain;
+                best_cost = cost;
+            }
+            cx += dx;
+            cy += dy;
+            if (!frontier_unknown(o, cx, cy) ||
+                    frontier->rejected[cx + (o->dim_x*cy)] ||
+                    (search_field_distance(field, cx, cy) != (d+1))) {
+                break;
+            }
+            ++d;
+            ++gain;
+            if (frontier_unknown(o, cx+dy, cy-dx)) {
+                ++gain;
+            }
+            cost += cell_ms;
+        }
+    }
+    if (best_x < 0) {
+        return 1;
+    }
+    *x = best_x;
+    *y = best_y;
+    return 0;
+}
+
+void search_frontier_free(search_frontier_t *frontier)
+{
+    if (frontier->occupancy &&
+            (frontier->occupancy->watch_context == frontier)) {
+        frontier->occupancy->watch = 0;
+        frontier->occupancy->watch_context = 0;
+    }
+    free(frontier->cells);
+    free(frontier->index);
+    free(frontier->rejected);
+    frontier->cells = frontier->index = 0;
+    frontier->rejected = 0;
+    frontier->count = 0;
+}
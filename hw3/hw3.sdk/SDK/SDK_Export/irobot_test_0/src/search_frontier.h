@@ -0,0 +1,59 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_frontier_h_
+#define _search_frontier_h_
+
+#include "search_field.h"
+#include "search_occupancy.h"
+
+// An exploration frontier over an occupancy grid: the unknown cells next to a
+// known free cell. The robot learns about a cell mostly by driving into it,
+// so the frontier cells themselves are the goals worth driving to.
+//
+// The frontier watches the grid, so it's kept up to date a cell at a time as
+// evidence comes in, rather than rescanned before every goal.
+//
+// Goals are picked by information gain per estimated drive time: how many
+// unknown cells the robot would drive through or pass with its wall sensor on
+// the way to a frontier cell, over the time the drive and its turns would
+// take from the origin of a distance field. A goal can lie straight on past
+// its frontier cell, into the unknown, since a longer run needs no more
+// turns and turns up more.
+typedef struct {
+    search_occupancy_t *occupancy;
+
+    // the frontier cells, in no particular order, and each cell's position
+    // in the list, -1 if it's not on the frontier.
+    int *cells, count;
+    int *index;
+
+    // cells given up on, kept off the frontier until they're known.
+    unsigned char *rejected;
+} search_frontier_t;
+
+// Allocate a frontier for the grid from the heap, and watch the grid, taking
+// the place of any other watcher.
+// Returns zero on success, non-zero on failure.
+int search_frontier_alloc(search_frontier_t *frontier,
+        search_occupancy_t *occupancy);
+
+// Rebuild the frontier from the grid, forgetting any cells given up on. Use
+// it after search_occupancy_clear.
+void search_frontier_rebuild(search_frontier_t *frontier);
+
+// Give up on unknown x,y, say when the robot couldn't get any closer to it.
+void search_frontier_reject(search_frontier_t *frontier, int x, int y);
+
+// Pick the goal reachable in field with the most information gain per
+// estimated drive time, where driving a cell takes cell_ms and a 90 degree
+// turn takes turn_ms.
+// Returns zero and sets x,y on success, non-zero if no frontier cell can be
+// reached.
+int search_frontier_pick(const search_frontier_t *frontier,
+        const search_field_t *field, int cell_ms, int turn_ms, int *x,
+        int *y);
+
+// Stop watching the grid, and free any dynamic memory associated with the
+// frontier.
+void search_frontier_free(search_frontier_t *frontier);
+#endif
@@ -0,0 +1,213 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_grid_h_
+#define _search_grid_h_
+
+// A* specialised at compile time for a grid of a fixed size. This is C++
+// only; C code reaches it through search_find, which hands searches of the
+// arena to the default instantiation.
+//
+// With the dimensions known to the compiler, the row stride is a constant,
+// so stepping to a neighbor is adding one of four precomputed offsets. The
+// grid is padded with a border of blocked sentinel cells, so a neighbor is
+// never off the grid and the inner loop needs no bounds checks: a blocked
+// byte test covers both obstacles and edges.
+//
+// Cells are addressed by padded index, index(x,y). The open list is a binary
+// min-heap ordered by (f,h), expanding neighbors in the same order as
+// search_find, so both find the same paths.
+#include <limits>
+#include "search_heap.h"
+
+// The default per cell search state. Any CellT with these members will do,
+// for instance with narrower types for a small grid.
+typedef struct {
+    // cost from the start, and the estimate to the goal.
+    int g, h;
+
+    // the padded index of the cell this one was reached from, -1 if none.
+    int parent;
+
+    // position in the open list, -1 if not open.
+    int heap_index;
+
+    // the search this state belongs to; older state is reset on first touch.
+    unsigned generation;
+    unsigned char closed;
+} search_grid_cell_t;
+
+template <int W, int H, typename CellT = search_grid_cell_t>
+struct search_grid_planner {
+    enum {
+        dim_x = W,
+        dim_y = H,
+        stride = W + 2,
+        size = (W + 2)*(H + 2),
+        cells = W*H
+    };
+
+    // the step to each neighbor, in search_find's order: -x, +x, -y, +y.
+    static const int offsets[4];
+
+    // non-zero for blocked cells and the sentinel border.
+    unsigned char blocked[size];
+    CellT cell[size];
+
+    // the open list, padded indices.
+    int heap[cells];
+    int heap_count;
+
+    // the current search, and the work the last one did.
+    unsigned generation;
+    int expanded, pushes, decreases, open_peak;
+
+    static int index(int x, int y)
+    {
+        return ((y + 1)*stride) + x + 1;
+    }
+
+    static int x_of(int i)
+    {
+        return (i % stride) - 1;
+    }
+
+    static int y_of(int i)
+    {
+        return (i / stride) - 1;
+    }
+
+    // Unblock every cell and forget any search state.
+    void clear()
+    {
+        for (int i = 0; i < size; ++i) {
+            const int x = x_of(i), y = y_of(i);
+            blocked[i] = (x < 0) || (y < 0) || (x >= W) || (y >= H);
+            cell[i].generation = 0;
+        }
+        heap_count = 0;
+        generation = 0;
+        expanded = pushes = decreases = open_peak = 0;
+    }
+
+    void set_blocked(int x, int y, int b)
+    {
+        blocked[index(x, y)] = b ? 1 : 0;
+    }
+
+    // Find goal from start, both padded indices. The path runs back from the
+    // goal through each cell's parent.
+    // Returns the length of the path, or -1 if the goal can't be reached.
+    int find(int start, int goal)
+    {
+        if (!++generation) {
+            for (int i = 0; i < size; ++i) {
+                cell[i].generation = 0;
+            }
+            generation = 1;
+        }
+        heap_count = 0;
+        expanded = pushes = decreases = open_peak = 0;
+        const int goal_x = x_of(goal), goal_y = y_of(goal);
+        touch(start, goal_x, goal_y);
+        touch(goal, goal_x, goal_y);
+        cell[start].g = 0;
+        push(start);
+        while (heap_count && !cell[goal].closed) {
+            const int c = search_heap_pop(heap, &heap_count, ops());
+            cell[c].closed = 1;
+            ++expanded;
+            const int g = cell[c].g + 1;
+            for (int m = 0; m < 4; ++m) {
+                const int n = c + offsets[m];
+                if (blocked[n]) {
+                    continue;
+                }
+                touch(n, goal_x, goal_y);
+                CellT &adj = cell[n];
+                if (adj.closed) {
+                    continue;
+                }
+                if (adj.heap_index >= 0) {
+                    if (g < adj.g) {
+                        adj.g = g;
+                        adj.parent = c;
+                        search_heap_decrease(heap, &heap_count, n, ops());
+                        ++decreases;
+                    }
+                    continue;
+                }
+
+                // No shortest path is longer than the grid has cells.
+                if ((g + adj.h) >= cells) {
+                    continue;
+                }
+                adj.g = g;
+                adj.parent = c;
+                push(n);
+            }
+        }
+        return cell[goal].closed ? cell[goal].g : -1;
+    }
+
+    // Reset a cell's search state if it's from an older search.
+    void touch(int i, int goal_x, int goal_y)
+    {
+        CellT &c = cell[i];
+        if (c.generation == generation) {
+            return;
+        }
+        const int dx = x_of(i) - goal_x, dy = y_of(i) - goal_y;
+        c.g = std::numeric_limits<int>::max();
+        c.h = ((dx < 0) ? -dx : dx) + ((dy < 0) ? -dy : dy);
+        c.parent = -1;
+        c.heap_index = -1;
+        c.closed = 0;
+        c.generation = generation;
+    }
+
+    // The open list's order and positions, for search_heap.h.
+    struct heap_ops {
+        search_grid_planner *p;
+
+        bool less(int a, int b) const
+        {
+            const CellT &x = p->cell[a], &y = p->cell[b];
+            const int fa = x.g + x.h, fb = y.g + y.h;
+            if (fa != fb) {
+                return fa < fb;
+            }
+            return x.h < y.h;
+        }
+
+        int index(int c) const
+        {
+            return p->cell[c].heap_index;
+        }
+
+        void place(int c, int i) const
+        {
+            p->cell[c].heap_index = i;
+        }
+    };
+
+    heap_ops ops()
+    {
+        const heap_ops o = { this };
+        return o;
+    }
+
+    void push(int c)
+    {
+        search_heap_push(heap, &heap_count, c, ops());
+        ++pushes;
+        if (heap_count > open_peak) {
+            open_peak = heap_count;
+        }
+    }
+};
+
+template <int W, int H, typename CellT>
+const int search_grid_planner<W, H, CellT>::offsets[4] = {
+    -1, 1, -(W + 2), (W + 2)};
+
+#endif
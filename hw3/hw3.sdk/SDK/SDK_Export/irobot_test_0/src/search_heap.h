@@ -0,0 +1,129 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_heap_h_
+#define _search_heap_h_
+
+// The indexed binary min-heap every planner's open list is built on. This is
+// C++ only. The heap is an array of items, cell pointers or state indices,
+// with room for every item up front, so nothing here allocates.
+//
+// Each item remembers its position in the heap so it can be moved when its
+// key changes. The planner owns the keys and the positions, and describes
+// them with an Ops type providing:
+//   bool less(T a, T b) const;    // a comes out of the heap before b
+//   int index(T item) const;      // the item's position, -1 if not in the heap
+//   void place(T item, int i);    // record the item's position, -1 on removal
+// An ops value is cheap to copy, usually just a pointer to the planner. Each
+// planner defines its ops type in an anonymous namespace.
+
+// Move the item at position i toward the root until ordered.
+template <typename T, typename Ops>
+void search_heap_sift_up(T *heap, int i, Ops ops)
+{
+    const T item = heap[i];
+    while (i > 0) {
+        const int parent = (i-1)/2;
+        if (!ops.less(item, heap[parent])) {
+            break;
+        }
+        heap[i] = heap[parent];
+        ops.place(heap[i], i);
+        i = parent;
+    }
+    heap[i] = item;
+    ops.place(item, i);
+}
+
+// Move the item at position i toward the leaves until ordered.
+template <typename T, typename Ops>
+void search_heap_sift_down(T *heap, int count, int i, Ops ops)
+{
+    const T item = heap[i];
+    for (;;) {
+        int child = (2*i)+1;
+        if (child >= count) {
+            break;
+        }
+        if (((child+1) < count) && ops.less(heap[child+1], heap[child])) {
+            ++child;
+        }
+        if (!ops.less(heap[child], item)) {
+            break;
+        }
+        heap[i] = heap[child];
+        ops.place(heap[i], i);
+        i = child;
+    }
+    heap[i] = item;
+    ops.place(item, i);
+}
+
+// Add an item that isn't in the heap.
+template <typename T, typename Ops>
+void search_heap_push(T *heap, int *count, T item, Ops ops)
+{
+    const int i = (*count)++;
+    heap[i] = item;
+    search_heap_sift_up(heap, i, ops);
+}
+
+// Remove and return the least item. The heap must not be empty.
+template <typename T, typename Ops>
+T search_heap_pop(T *heap, int *count, Ops ops)
+{
+    const T item = heap[0];
+    if (--*count) {
+        heap[0] = heap[*count];
+        search_heap_sift_down(heap, *count, 0, ops);
+    }
+    ops.place(item, -1);
+    return item;
+}
+
+// Add an item, or restore order after its key was lowered.
+template <typename T, typename Ops>
+void search_heap_decrease(T *heap, int *count, T item, Ops ops)
+{
+    if (ops.index(item) < 0) {
+        search_heap_push(heap, count, item, ops);
+        return;
+    }
+    search_heap_sift_up(heap, ops.index(item), ops);
+}
+
+// Add an item, or restore order after its key changed either way.
+template <typename T, typename Ops>
+void search_heap_update(T *heap, int *count, T item, Ops ops)
+{
+    if (ops.index(item) < 0) {
+        search_heap_push(heap, count, item, ops);
+        return;
+    }
+    search_heap_sift_up(heap, ops.index(item), ops);
+    search_heap_sift_down(heap, *count, ops.index(item), ops);
+}
+
+// Remove an item that's in the heap.
+template <typename T, typename Ops>
+void search_heap_remove(T *heap, int *count, T item, Ops ops)
+{
+    const int i = ops.index(item);
+    const T last = heap[--*count];
+    ops.place(item, -1);
+    if (i == *count) {
+        return;
+    }
+    heap[i] = last;
+    search_heap_sift_up(heap, i, ops);
+    search_heap_sift_down(heap, *count, ops.index(last), ops);
+}
+
+// Order count items already in the array, after many keys changed at once.
+template <typename T, typename Ops>
+void search_heap_build(T *heap, int count, Ops ops)
+{
+    for (int i = (count/2)-1; i >= 0; --i) {
+        search_heap_sift_down(heap, count, i, ops);
+    }
+}
+#endif
@@ -0,0 +1,568 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <vector>
+
+extern "C" {
+#include "search_hpa.h"
+}
+#include "search_heap.h"
+
+static const int infinity = std::numeric_limits<int>::max()/4;
+
+static const int moves[][2] = {{-1,0},{1,0},{0,-1},{0,1}};
+
+// Entrances at least this long get a portal at each end rather than one in
+// the middle, which keeps paths along long open borders from zig-zagging.
+static const int wide_entrance = 6;
+
+// A cluster's portals, each a cell in the cluster with its partner cell
+// across the border and the partner's portal index in its own cluster, and
+// the distances between them within the cluster.
+struct cluster_t {
+    std::vector<int> nodes;
+    std::vector<int> partner;
+    std::vector<int> link;
+    std::vector<int> dist;
+};
+
+// The abstract graph. A border of n cells has at most n portals, so a
+// cluster has at most 4*size, and portal i of cluster k is node
+// (k*stride)+i. Node numbers stay put when other clusters are rebuilt.
+//
+// The abstract search state is kept here too, stamped with the query that
+// wrote it, so a query only touches the nodes it reaches. Its open list is
+// ordered by f, then by node.
+//
+// So a query doesn't allocate, the scratch space for searching within a
+// cluster and for the paths is sized once, for the largest cluster.
+struct search_hpa_graph {
+    std::vector<cluster_t> clusters;
+    int stride;
+    std::vector<int> g, f, parent;
+    std::vector<int> heap, heap_index;
+    int heap_count;
+    std::vector<unsigned> stamp;
+    unsigned query;
+
+    // per cluster flags for search_hpa_update.
+    std::vector<char> changed, stale;
+
+    // per cell scratch for cluster_bfs, and the distances from the start and
+    // the goal within their clusters.
+    std::vector<char> closed;
+    std::vector<int> queue, dist, bfs_parent;
+    std::vector<int> start_dist, goal_dist;
+
+    // the abstract path, and the leg being refined.
+    std::vector<int> abstract, leg;
+};
+
+// The bounds of a cluster, in cells, [x0,x1) by [y0,y1).
+struct bounds_t {
+    int x0, y0, x1, y1;
+};
+
+static bounds_t cluster_bounds(const search_hpa_t *hpa, int k)
+{
+    bounds_t b;
+    b.x0 = (k % hpa->clusters_x)*hpa->size;
+    b.y0 = (k / hpa->clusters_x)*hpa->size;
+    b.x1 = std::min(b.x0+hpa->size, hpa->map->dim_x);
+    b.y1 = std::min(b.y0+hpa->size, hpa->map->dim_y);
+    return b;
+}
+
+static int cluster_of(const search_hpa_t *hpa, int cell)
+{
+    const int x = cell % hpa->map->dim_x;
+    const int y = cell / hpa->map->dim_x;
+    return (x/hpa->size) + (hpa->clusters_x*(y/hpa->size));
+}
+
+static int blocked(const search_hpa_t *hpa, int x, int y)
+{
+    return search_bits_test(&hpa->map->bits, x, y);
+}
+
+// Breadth-first search from a cell without leaving its cluster, stopping
+// early once the cell at local index to is reached, if to isn't -1. dist
+// and parent are indexed by cell position within the cluster, and are sized
+// for the largest cluster.
+static void cluster_bfs(const search_hpa_t *hpa, const bounds_t &b, int from,
+        std::vector<int> &dist, std::vector<int> &parent, int to = -1)
+{
+    const int w = b.x1 - b.x0;
+    const int size = w*(b.y1-b.y0);
+    std::fill(dist.begin(), dist.begin()+size, infinity);
+    std::fill(parent.begin(), parent.begin()+size, -1);
+
+    // Cells are closed once queued; blocked cells start out closed.
+    std::vector<char> &closed = hpa->graph->closed;
+    for (int i = 0; i < size; ++i) {
+        closed[i] = blocked(hpa, b.x0+(i%w), b.y0+(i/w));
+    }
+    std::vector<int> &queue = hpa->graph->queue;
+    int head = 0, tail = 0;
+    const int local = ((from % hpa->map->dim_x)-b.x0) +
+        (w*((from / hpa->map->dim_x)-b.y0));
+    dist[local] = 0;
+    closed[local] = 1;
+    queue[tail++] = local;
+    while (head < tail) {
+        const int i = queue[head++];
+        if (i == to) {
+            break;
+        }
+        const int x = i % w;
+        const int y = i / w;
+        for (int m = 0; m < 4; ++m) {
+            const int nx = x + moves[m][0];
+            const int ny = y + moves[m][1];
+            if ((nx < 0) || (ny < 0) || ((b.x0+nx) >= b.x1) || ((b.y0+ny) >= b.y1)) {
+                continue;
+            }
+            const int n = nx + (w*ny);
+            if (closed[n]) {
+                continue;
+            }
+            closed[n] = 1;
+            dist[n] = dist[i] + 1;
+            parent[n] = i;
+            queue[tail++] = n;
+        }
+    }
+}
+
+static int local_index(const search_hpa_t *hpa, const bounds_t &b, int cell)
+{
+    return ((cell % hpa->map->dim_x)-b.x0) +
+        ((b.x1-b.x0)*((cell / hpa->map->dim_x)-b.y0));
+}
+
+// Find the portals on one border of a cluster. The cells at inside and
+// outside are walked together along the border; runs where both are free
+// are the entrances. Both clusters sharing the border find the same runs,
+// so every portal's partner is a portal too.
+static void border_portals(const search_hpa_t *hpa, cluster_t &c, int x, int y,
+        int ox, int oy, int dx, int dy, int length)
+{
+    const int dim_x = hpa->map->dim_x;
+    int run = -1;
+    for (int i = 0; i <= length; ++i) {
+        const int open = (i < length) &&
+            !blocked(hpa, x+(dx*i), y+(dy*i)) &&
+            !blocked(hpa, x+ox+(dx*i), y+oy+(dy*i));
+        if (open && (run < 0)) {
+            run = i;
+        }
+        if (open || (run < 0)) {
+            continue;
+        }
+        int at[2] = {(run+i-1)/2, -1};
+        if ((i-run) >= wide_entrance) {
+            at[0] = run;
+            at[1] = i-1;
+        }
+        for (int p = 0; (p < 2) && (at[p] >= 0); ++p) {
+            const int px = x+(dx*at[p]);
+            const int py = y+(dy*at[p]);
+            c.nodes.push_back(px + (dim_x*py));
+            c.partner.push_back((px+ox) + (dim_x*(py+oy)));
+        }
+        run = -1;
+    }
+}
+
+// Rebuild a cluster's portals and the distances between them.
+static void cluster_build(const search_hpa_t *hpa, int k)
+{
+    cluster_t &c = hpa->graph->clusters[k];
+    const bounds_t b = cluster_bounds(hpa, k);
+    c.nodes.clear();
+    c.partner.clear();
+    border_portals(hpa, c, b.x0, b.y0, -1, 0, 0, 1, b.y1-b.y0);
+    border_portals(hpa, c, b.x1-1, b.y0, 1, 0, 0, 1, b.y1-b.y0);
+    border_portals(hpa, c, b.x0, b.y0, 0, -1, 1, 0, b.x1-b.x0);
+    border_portals(hpa, c, b.x0, b.y1-1, 0, 1, 1, 0, b.x1-b.x0);
+
+    const int n = c.nodes.size();
+    c.dist.assign(n*n, infinity);
+    std::vector<int> &dist = hpa->graph->dist;
+    for (int i = 0; i < n; ++i) {
+        cluster_bfs(hpa, b, c.nodes[i], dist, hpa->graph->bfs_parent);
+        for (int j = 0; j < n; ++j) {
+            c.dist[(i*n)+j] = dist[local_index(hpa, b, c.nodes[j])];
+        }
+    }
+}
+
+// Find the partner portal of each of a cluster's portals.
+static void cluster_link(const search_hpa_t *hpa, int k)
+{
+    cluster_t &c = hpa->graph->clusters[k];
+    c.link.assign(c.nodes.size(), -1);
+    for (unsigned i = 0; i < c.nodes.size(); ++i) {
+        const cluster_t &p = hpa->graph->clusters[cluster_of(hpa, c.partner[i])];
+        for (unsigned j = 0; j < p.nodes.size(); ++j) {
+            if ((p.nodes[j] == c.partner[i]) && (p.partner[j] == c.nodes[i])) {
+                c.link[i] = j;
+                break;
+            }
+        }
+    }
+}
+
+int search_hpa_alloc(search_hpa_t *hpa, search_map_t *map, int size)
+{
+    hpa->map = map;
+    hpa->size = size;
+    hpa->clusters_x = (map->dim_x+size-1)/size;
+    hpa->clusters_y = (map->dim_y+size-1)/size;
+    hpa->built = 0;
+    hpa->graph = new (std::nothrow) search_hpa_graph;
+    if (!hpa->graph) {
+        std::cout << "malloc failed" << std::endl;
+        return 1;
+    }
+    const int count = hpa->clusters_x*hpa->clusters_y;
+    const int nodes = (count*4*size)+2;
+    search_hpa_graph *graph = hpa->graph;
+    graph->clusters.resize(count);
+    graph->stride = 4*size;
+    graph->g.resize(nodes);
+    graph->f.resize(nodes);
+    graph->parent.resize(nodes);
+    graph->heap.resize(nodes);
+    graph->heap_index.resize(nodes);
+    graph->heap_count = 0;
+    graph->stamp.assign(nodes, 0);
+    graph->query = 0;
+    graph->changed.resize(count);
+    graph->stale.resize(count);
+    graph->closed.resize(size*size);
+    graph->queue.resize(size*size);
+    graph->dist.resize(size*size);
+    graph->bfs_parent.resize(size*size);
+    graph->start_dist.resize(size*size);
+    graph->goal_dist.resize(size*size);
+    graph->abstract.reserve(nodes);
+    graph->leg.reserve(size*size);
+    if (search_bits_alloc(&hpa->seen, map->dim_x, map->dim_y)) {
+        delete hpa->graph;
+        hpa->graph = 0;
+        return 1;
+    }
+    return 0;
+}
+
+void search_hpa_free(search_hpa_t *hpa)
+{
+    delete hpa->graph;
+    hpa->graph = 0;
+    search_bits_free(&hpa->seen);
+    hpa->built = 0;
+}
+
+int search_hpa_update(search_hpa_t *hpa)
+{
+    const search_bits_t *bits = &hpa->map->bits;
+    const int count = hpa->clusters_x*hpa->clusters_y;
+    std::vector<char> &changed = hpa->graph->changed;
+    std::fill(changed.begin(), changed.end(), !hpa->built);
+
+    // Find the clusters with changed cells a word at a time.
+    if (hpa->built) {
+        for (int y = 0; y < bits->dim_y; ++y) {
+            for (int w = 0; w < bits->words; ++w) {
+                uint64_t diff = bits->rows[(bits->words*y)+w] ^
+                    hpa->seen.rows[(bits->words*y)+w];
+                while (diff) {
+                    const int x = (w*64) + __builtin_ctzll(diff);
+                    diff &= diff-1;
+                    changed[cluster_of(hpa, x + (bits->dim_x*y))] = 1;
+                }
+            }
+        }
+    }
+
+    // A changed cluster's borders are shared with its neighbors.
+    std::vector<char> &stale = hpa->graph->stale;
+    stale = changed;
+    for (int k = 0; k < count; ++k) {
+        if (!changed[k]) {
+            continue;
+        }
+        const int cx = k % hpa->clusters_x;
+        const int cy = k / hpa->clusters_x;
+        if (cx > 0) {
+            stale[k-1] = 1;
+        }
+        if ((cx+1) < hpa->clusters_x) {
+            stale[k+1] = 1;
+        }
+        if (cy > 0) {
+            stale[k-hpa->clusters_x] = 1;
+        }
+        if ((cy+1) < hpa->clusters_y) {
+            stale[k+hpa->clusters_x] = 1;
+        }
+    }
+
+    int rebuilt = 0;
+    for (int k = 0; k < count; ++k) {
+        if (stale[k]) {
+            cluster_build(hpa, k);
+            ++rebuilt;
+        }
+    }
+
+    // Links into a rebuilt cluster may have moved, and only neighbors of a
+    // rebuilt cluster link into it.
+    for (int k = 0; k < count; ++k) {
+        if (stale[k]) {
+            cluster_link(hpa, k);
+            continue;
+        }
+        const int cx = k % hpa->clusters_x;
+        const int cy = k / hpa->clusters_x;
+        if (((cx > 0) && stale[k-1]) ||
+                (((cx+1) < hpa->clusters_x) && stale[k+1]) ||
+                ((cy > 0) && stale[k-hpa->clusters_x]) ||
+                (((cy+1) < hpa->clusters_y) && stale[k+hpa->clusters_x])) {
+            cluster_link(hpa, k);
+        }
+    }
+    memcpy(hpa->seen.rows, bits->rows,
+            sizeof(uint64_t)*bits->words*bits->dim_y);
+    hpa->built = 1;
+    return rebuilt;
+}
+
+// The abstract search. The two nodes past the portals are the start and
+// the goal, which are joined to the portals of their clusters for this
+// query only.
+struct query_t {
+    const search_hpa_t *hpa;
+    int start, goal;
+    int start_node, goal_node;
+    bounds_t start_bounds, goal_bounds;
+};
+
+static int node_cell(const query_t &q, int u)
+{
+    const search_hpa_graph *g = q.hpa->graph;
+    if (u == q.start_node) {
+        return q.start;
+    }
+    if (u == q.goal_node) {
+        return q.goal;
+    }
+    return g->clusters[u/g->stride].nodes[u%g->stride];
+}
+
+static int h_distance(const query_t &q, int cell)
+{
+    const int dim_x = q.hpa->map->dim_x;
+    return std::abs((cell%dim_x)-(q.goal%dim_x))
+        + std::abs((cell/dim_x)-(q.goal/dim_x));
+}
+
+// The cost of reaching a node in this query.
+static int node_g(const search_hpa_graph *graph, int u)
+{
+    return (graph->stamp[u] == graph->query) ? graph->g[u] : infinity;
+}
+
+namespace {
+
+// The open list's order and positions, for search_heap.h. A node is only on
+// the open list if this query reached it.
+struct hpa_heap_ops {
+    search_hpa_graph *graph;
+
+    bool less(int a, int b) const
+    {
+        if (graph->f[a] != graph->f[b]) {
+            return graph->f[a] < graph->f[b];
+        }
+        return a < b;
+    }
+
+    int index(int u) const
+    {
+        return (graph->stamp[u] == graph->query) ? graph->heap_index[u] : -1;
+    }
+
+    void place(int u, int i) const
+    {
+        graph->heap_index[u] = i;
+    }
+};
+
+hpa_heap_ops ops(search_hpa_graph *graph)
+{
+    const hpa_heap_ops o = { graph };
+    return o;
+}
+
+}
+
+static void relax(const query_t &q, int u, int v, int cost)
+{
+    search_hpa_graph *graph = q.hpa->graph;
+    const int g = graph->g[u] + cost;
+    if ((cost >= infinity) || (g >= node_g(graph, v))) {
+        return;
+    }
+    if (graph->stamp[v] != graph->query) {
+        graph->stamp[v] = graph->query;
+        graph->heap_index[v] = -1;
+    }
+    graph->g[v] = g;
+    graph->f[v] = g+h_distance(q, node_cell(q, v));
+    graph->parent[v] = u;
+    search_heap_decrease(&graph->heap[0], &graph->heap_count, v, ops(graph));
+}
+
+// Search the abstract graph, leaving the abstract path as cells, start to
+// goal, in graph->abstract.
+// Returns zero on success, non-zero if the goal can't be reached.
+static int abstract_find(const query_t &q)
+{
+    search_hpa_graph *graph = q.hpa->graph;
+    const int start_cluster = cluster_of(q.hpa, q.start);
+    const int goal_cluster = cluster_of(q.hpa, q.goal);
+    const int stride = graph->stride;
+    if (!++graph->query) {
+        graph->stamp.assign(graph->stamp.size(), 0);
+        graph->query = 1;
+    }
+
+    graph->heap_count = 0;
+    graph->stamp[q.start_node] = graph->query;
+    graph->heap_index[q.start_node] = -1;
+    graph->g[q.start_node] = 0;
+    graph->f[q.start_node] = h_distance(q, q.start);
+    graph->parent[q.start_node] = -1;
+    search_heap_push(&graph->heap[0], &graph->heap_count, q.start_node,
+            ops(graph));
+    while (graph->heap_count) {
+        const int u = search_heap_pop(&graph->heap[0], &graph->heap_count,
+                ops(graph));
+        if (u == q.goal_node) {
+            break;
+        }
+
+        if (u == q.start_node) {
+            const cluster_t &c = graph->clusters[start_cluster];
+            for (unsigned j = 0; j < c.nodes.size(); ++j) {
+                relax(q, u, (start_cluster*stride)+j,
+                        graph->start_dist[local_index(q.hpa, q.start_bounds, c.nodes[j])]);
+            }
+            if (start_cluster == goal_cluster) {
+                relax(q, u, q.goal_node,
+                        graph->start_dist[local_index(q.hpa, q.start_bounds, q.goal)]);
+            }
+            continue;
+        }
+
+        const int k = u / stride;
+        const int i = u % stride;
+        const cluster_t &c = graph->clusters[k];
+        const int n = c.nodes.size();
+        for (int j = 0; j < n; ++j) {
+            if (j != i) {
+                relax(q, u, (k*stride)+j, c.dist[(i*n)+j]);
+            }
+        }
+        if (k == goal_cluster) {
+            relax(q, u, q.goal_node,
+                    graph->goal_dist[local_index(q.hpa, q.goal_bounds, c.nodes[i])]);
+        }
+
+        // Cross the border to the partner portal.
+        if (c.link[i] >= 0) {
+            relax(q, u,
+                    (cluster_of(q.hpa, c.partner[i])*stride)+c.link[i], 1);
+        }
+    }
+
+    std::vector<int> &path = graph->abstract;
+    path.clear();
+    if (node_g(graph, q.goal_node) >= infinity) {
+        return 1;
+    }
+    for (int u = q.goal_node; u >= 0; u = graph->parent[u]) {
+        path.push_back(node_cell(q, u));
+    }
+    std::reverse(path.begin(), path.end());
+    return 0;
+}
+
+int search_hpa_find(search_hpa_t *hpa, search_cell_t *start,
+        search_cell_t *goal)
+{
+    search_map_t *map = hpa->map;
+    search_hpa_graph *graph = hpa->graph;
+    if (goal->blocked) {
+        return 1;
+    }
+    search_hpa_update(hpa);
+
+    query_t q;
+    q.hpa = hpa;
+    q.start = start - map->cells;
+    q.goal = goal - map->cells;
+    q.start_node = hpa->clusters_x*hpa->clusters_y*hpa->graph->stride;
+    q.goal_node = q.start_node+1;
+    q.start_bounds = cluster_bounds(hpa, cluster_of(hpa, q.start));
+    q.goal_bounds = cluster_bounds(hpa, cluster_of(hpa, q.goal));
+    std::vector<int> &parent = graph->bfs_parent;
+    cluster_bfs(hpa, q.start_bounds, q.start, graph->start_dist, parent);
+    cluster_bfs(hpa, q.goal_bounds, q.goal, graph->goal_dist, parent);
+
+    if (abstract_find(q)) {
+        return 1;
+    }
+
+    // Refine each leg within its cluster, and thread the cells.
+    const std::vector<int> &abstract = graph->abstract;
+    std::vector<int> &leg = graph->leg;
+    start->prev = 0;
+    search_cell_t *last = start;
+    for (unsigned i = 1; i < abstract.size(); ++i) {
+        const int from = abstract[i-1];
+        const int to = abstract[i];
+        if (from == to) {
+            continue;
+        }
+        leg.clear();
+        const int k = cluster_of(hpa, from);
+        if (k != cluster_of(hpa, to)) {
+            leg.push_back(to);
+        } else {
+            const bounds_t b = cluster_bounds(hpa, k);
+            const int w = b.x1 - b.x0;
+            cluster_bfs(hpa, b, from, graph->dist, parent,
+                    local_index(hpa, b, to));
+            for (int l = local_index(hpa, b, to); parent[l] >= 0; l = parent[l]) {
+                leg.push_back((b.x0+(l%w)) + (map->dim_x*(b.y0+(l/w))));
+            }
+            std::reverse(leg.begin(), leg.end());
+        }
+        for (unsigned j = 0; j < leg.size(); ++j) {
+            search_cell_t *c = &map->cells[leg[j]];
+            last->next = c;
+            c->prev = last;
+            last = c;
+        }
+    }
+    last->next = 0;
+    return 0;
+}
@@ -0,0 +1,54 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_hpa_h_
+#define _search_hpa_h_
+
+#include "search.h"
+
+// A hierarchical planner (HPA*) for maps too big to search cell by cell.
+// The map is cut into square clusters. Where free cells face each other
+// across a cluster border there is an entrance, and each entrance puts a
+// portal cell on both sides. Within a cluster the distances between its
+// portals are cached, so a query searches the small graph of portals and
+// then refines only the clusters the abstract path passes through.
+//
+// The cache follows the map's bitboard: each query compares the bitboard
+// with the one the cache was built from, and rebuilds only the clusters
+// whose blocked cells changed, along with their neighbors, which share
+// their borders. Paths are close to, but not always, the shortest.
+struct search_hpa_graph;
+
+typedef struct {
+    search_map_t *map;
+
+    // the side of a cluster in cells, and the number of clusters.
+    int size;
+    int clusters_x, clusters_y;
+
+    // the portals and cached distances of every cluster.
+    struct search_hpa_graph *graph;
+
+    // the bitboard the cache was built from.
+    search_bits_t seen;
+    int built;
+} search_hpa_t;
+
+// Allocate planner state for the map from the heap, with clusters of size
+// by size cells.
+// Returns zero on success, non-zero on failure.
+int search_hpa_alloc(search_hpa_t *hpa, search_map_t *map, int size);
+
+// Bring the cache up to date with the map. search_hpa_find does this
+// itself; it's exposed to move the work out of a time-critical query.
+// Returns the number of clusters rebuilt.
+int search_hpa_update(search_hpa_t *hpa);
+
+// Find the goal from start. On success the path is threaded through the
+// cells' prev and next fields, just like search_find.
+// Returns zero on success, non-zero if the goal can't be reached.
+int search_hpa_find(search_hpa_t *hpa, search_cell_t *start,
+        search_cell_t *goal);
+
+// Free any dynamic memory associated with the planner.
+void search_hpa_free(search_hpa_t *hpa);
+#endif
@@ -0,0 +1,227 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#include <iostream>
+#include <cstdlib>
+#include <limits>
+
+extern "C" {
+#include "search_lattice.h"
+}
+#include "search_heap.h"
+
+static const int infinity = std::numeric_limits<int>::max()/4;
+
+// The cell delta of driving along each heading.
+static const int moves[][2] = {{-1,0},{0,1},{1,0},{0,-1}};
+
+// The number of 90 degree turns between two headings.
+static int turns(int a, int b)
+{
+    const int d = (a-b) & 3;
+    return (d == 3) ? 1 : d;
+}
+
+// A lower bound on the cost from a state to the goal. Every cell of the
+// displacement has to be driven, and the robot has to face each direction
+// it drives in, in some order, and then turn to the goal heading.
+static int h_cost(const search_lattice_t *lattice, int x, int y, int heading,
+        const search_cell_t *goal, int goal_heading)
+{
+    const int dx = goal->x - x;
+    const int dy = goal->y - y;
+    int need[2];
+    int count = 0;
+    if (dx) {
+        need[count++] = (dx < 0) ? search_heading_left : search_heading_right;
+    }
+    if (dy) {
+        need[count++] = (dy < 0) ? search_heading_back : search_heading_forward;
+    }
+
+    int best = infinity;
+    for (int order = 0; order < ((count == 2) ? 2 : 1); ++order) {
+        int h = heading;
+        int t = 0;
+        for (int i = 0; i < count; ++i) {
+            const int next = need[(i+order) % count];
+            t += turns(h, next);
+            h = next;
+        }
+        if (goal_heading != search_heading_any) {
+            t += turns(h, goal_heading);
+        }
+        if (t < best) {
+            best = t;
+        }
+    }
+    return (lattice->step_cost*(std::abs(dx)+std::abs(dy)))
+        + (lattice->turn_cost*best);
+}
+
+// Open list order. Ties on f go to the state that's furthest along.
+static bool state_less(const search_lattice_t *l, int a, int b)
+{
+    if (l->f[a] != l->f[b]) {
+        return l->f[a] < l->f[b];
+    }
+    return l->g[a] > l->g[b];
+}
+
+namespace {
+
+// The open list's order and positions, for search_heap.h.
+struct lattice_heap_ops {
+    search_lattice_t *l;
+
+    bool less(int a, int b) const
+    {
+        return state_less(l, a, b);
+    }
+
+    int index(int c) const
+    {
+        return l->heap_index[c];
+    }
+
+    void place(int c, int i) const
+    {
+        l->heap_index[c] = i;
+    }
+};
+
+lattice_heap_ops ops(search_lattice_t *l)
+{
+    const lattice_heap_ops o = { l };
+    return o;
+}
+
+}
+
+// Reach state t from s at cost g, if that's better than what t has. States
+// are reopened when improved, so the heuristic need not be consistent.
+static void relax(search_lattice_t *l, int s, int t, int g,
+        const search_cell_t *goal, int goal_heading)
+{
+    if (g >= l->g[t]) {
+        return;
+    }
+    const search_cell_t *c = &l->map->cells[t>>2];
+    l->g[t] = g;
+    l->f[t] = g + h_cost(l, c->x, c->y, t&3, goal, goal_heading);
+    l->parent[t] = s;
+    if (l->heap_index[t] < 0) {
+        search_stats_push(l->map->stats, l->heap_count+1);
+    } else {
+        search_stats_decrease(l->map->stats);
+    }
+    search_heap_decrease(l->heap, &l->heap_count, t, ops(l));
+}
+
+int search_lattice_alloc(search_lattice_t *lattice, search_map_t *map,
+        int step_cost, int turn_cost)
+{
+    const int states = 4*map->dim_x*map->dim_y;
+    lattice->map = map;
+    lattice->step_cost = step_cost;
+    lattice->turn_cost = turn_cost;
+    lattice->g = (int*)malloc(sizeof(int)*states);
+    lattice->parent = (int*)malloc(sizeof(int)*states);
+    lattice->heap = (int*)malloc(sizeof(int)*states);
+    lattice->heap_index = (int*)malloc(sizeof(int)*states);
+    lattice->f = (int*)malloc(sizeof(int)*states);
+    lattice->heap_count = 0;
+    if (!lattice->g || !lattice->parent || !lattice->heap ||
+            !lattice->heap_index || !lattice->f) {
+        std::cout << "malloc failed" << std::endl;
+        search_lattice_free(lattice);
+        return 1;
+    }
+    return 0;
+}
+
+void search_lattice_free(search_lattice_t *lattice)
+{
+    free(lattice->g);
+    free(lattice->parent);
+    free(lattice->heap);
+    free(lattice->heap_index);
+    free(lattice->f);
+    lattice->g = lattice->parent = lattice->heap = lattice->heap_index = 0;
+    lattice->f = 0;
+    lattice->heap_count = 0;
+}
+
+// Search the lattice and thread the path, returning its cost or -1.
+static int find(search_lattice_t *lattice, search_cell_t *start,
+        int start_heading, search_cell_t *goal, int goal_heading)
+{
+    search_map_t *map = lattice->map;
+    const int states = 4*map->dim_x*map->dim_y;
+    for (int s = 0; s < states; ++s) {
+        lattice->g[s] = infinity;
+        lattice->heap_index[s] = -1;
+    }
+    lattice->heap_count = 0;
+
+    std::cout << "start: " << start->x << "," << start->y << " "
+        << "goal: " << goal->x << "," << goal->y << std::endl;
+
+    const int first = (4*(start - map->cells)) + start_heading;
+    relax(lattice, -1, first, 0, goal, goal_heading);
+
+    int last = -1;
+    while (lattice->heap_count) {
+        const int s = search_heap_pop(lattice->heap, &lattice->heap_count,
+                ops(lattice));
+        search_stats_pop(map->stats);
+        search_stats_expand(map->stats, 1);
+        const search_cell_t *c = &map->cells[s>>2];
+        const int heading = s&3;
+        if ((c == goal) && ((goal_heading == search_heading_any) ||
+                    (heading == goal_heading))) {
+            last = s;
+            break;
+        }
+
+        // Turn in place either way.
+        const int g = lattice->g[s];
+        relax(lattice, s, (s&~3)|((heading+1)&3), g+lattice->turn_cost,
+                goal, goal_heading);
+        relax(lattice, s, (s&~3)|((heading+3)&3), g+lattice->turn_cost,
+                goal, goal_heading);
+
+        // Drive one cell along the heading.
+        const int x = c->x + moves[heading][0];
+        const int y = c->y + moves[heading][1];
+        if (!search_bits_test(&map->bits, x, y)) {
+            const int i = x + (map->dim_x*y);
+            relax(lattice, s, (4*i)+heading, g+lattice->step_cost,
+                    goal, goal_heading);
+        }
+    }
+    if (last < 0) {
+        return -1;
+    }
+
+    // Thread the cells of the path, skipping turns in place.
+    goal->next = 0;
+    for (int s = last; s != first; s = lattice->parent[s]) {
+        search_cell_t *c = &map->cells[s>>2];
+        search_cell_t *p = &map->cells[lattice->parent[s]>>2];
+        if (p != c) {
+            p->next = c;
+            c->prev = p;
+        }
+    }
+    start->prev = 0;
+    return lattice->g[last];
+}
+
+int search_lattice_find(search_lattice_t *lattice, search_cell_t *start,
+        int start_heading, search_cell_t *goal, int goal_heading)
+{
+    search_stats_begin(lattice->map->stats);
+    const int cost = find(lattice, start, start_heading, goal, goal_heading);
+    search_stats_end(lattice->map->stats, cost >= 0);
+    return cost;
+}
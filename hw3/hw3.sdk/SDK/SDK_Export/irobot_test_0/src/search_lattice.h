@@ -0,0 +1,57 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_lattice_h_
+#define _search_lattice_h_
+
+#include "search.h"
+
+// A turn-aware planner. search_find counts cells, but the robot spends real
+// time turning in place, so the shortest path isn't always the quickest.
+// This searches the state lattice of (x, y, heading): a state either drives
+// one cell along its heading or turns 90 degrees in place, and each has its
+// own cost. The path found minimizes the total cost, which is elapsed time
+// when the costs are the times of each maneuver.
+//
+// Headings use the direction_t encoding, which this must agree with.
+typedef enum {
+    search_heading_left    = 0,
+    search_heading_forward = 1,
+    search_heading_right   = 2,
+    search_heading_back    = 3,
+} search_heading_t;
+
+// Pass as the goal heading to accept arriving with any heading.
+#define search_heading_any (-1)
+
+// All per state arrays are indexed by (4 * cell index) + heading.
+typedef struct {
+    search_map_t *map;
+
+    // the cost of driving one cell, and of turning 90 degrees.
+    int step_cost, turn_cost;
+
+    // best cost from the start, and the state it was reached from.
+    int *g, *parent;
+
+    // the open list, a binary min-heap of states ordered by f.
+    int *heap, heap_count;
+    int *heap_index;
+    int *f;
+} search_lattice_t;
+
+// Allocate planner state for the map from the heap, with the given costs.
+// Returns zero on success, non-zero on failure.
+int search_lattice_alloc(search_lattice_t *lattice, search_map_t *map,
+        int step_cost, int turn_cost);
+
+// Find the quickest path from start, facing start_heading, to goal, ending
+// with goal_heading (or search_heading_any). Turning back to the goal
+// heading counts toward the cost. On success the path is threaded through
+// the cells' prev and next fields, just like search_find.
+// Returns the cost of the path, or -1 if the goal can't be reached.
+int search_lattice_find(search_lattice_t *lattice, search_cell_t *start,
+        int start_heading, search_cell_t *goal, int goal_heading);
+
+// Free any dynamic memory associated with the planner.
+void search_lattice_free(search_lattice_t *lattice);
+#endif
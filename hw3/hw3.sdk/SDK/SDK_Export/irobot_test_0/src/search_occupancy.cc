@@ -0,0 +1,116 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+#include "search_occupancy.h"
+}
+
+// Set a cell's odds, bringing its threshold view in line and telling the
+// watcher if anything it cares about changed.
+// Returns non-zero if the threshold view changed.
+static int set(search_occupancy_t *o, int c, int odds)
+{
+    const int was_known = (o->odds[c] != 0);
+    const int was = o->occupied[c];
+    o->odds[c] = (signed char)odds;
+    if (odds >= o->occupied_odds) {
+        o->occupied[c] = 1;
+    } else if (odds < o->free_odds) {
+        o->occupied[c] = 0;
+    }
+    const int changed = (o->occupied[c] != was);
+    if (o->watch && (changed || (was_known != (odds != 0)))) {
+        o->watch(o->watch_context, c%o->dim_x, c/o->dim_x);
+    }
+    return changed;
+}
+
+int search_occupancy_alloc(search_occupancy_t *occupancy, int dim_x,
+        int dim_y, int occupied_odds, int free_odds)
+{
+    occupancy->dim_x = dim_x;
+    occupancy->dim_y = dim_y;
+    occupancy->occupied_odds = occupied_odds;
+    occupancy->free_odds = free_odds;
+    occupancy->watch = 0;
+    occupancy->watch_context = 0;
+    occupancy->odds = (signed char*)malloc(dim_x*dim_y);
+    occupancy->occupied = (unsigned char*)malloc(dim_x*dim_y);
+    if (!occupancy->odds || !occupancy->occupied) {
+        std::cout << "malloc failed" << std::endl;
+        search_occupancy_free(occupancy);
+        return 1;
+    }
+    search_occupancy_clear(occupancy);
+    return 0;
+}
+
+void search_occupancy_clear(search_occupancy_t *occupancy)
+{
+    const int cells = occupancy->dim_x*occupancy->dim_y;
+    memset(occupancy->odds, 0, cells);
+    memset(occupancy->occupied, 0, cells);
+}
+
+int search_occupancy_update(search_occupancy_t *occupancy, int x, int y,
+        int odds)
+{
+    if ((x < 0) || (y < 0) || (x >= occupancy->dim_x) ||
+            (y >= occupancy->dim_y)) {
+        return 0;
+    }
+    const int c = x + (occupancy->dim_x*y);
+    int sum = occupancy->odds[c] + odds;
+    if (sum > 127) {
+        sum = 127;
+    } else if (sum < -127) {
+        sum = -127;
+    }
+    return set(occupancy, c, sum);
+}
+
+int search_occupancy_occupied(const search_occupancy_t *occupancy, int x,
+        int y)
+{
+    if ((x < 0) || (y < 0) || (x >= occupancy->dim_x) ||
+            (y >= occupancy->dim_y)) {
+        return 0;
+    }
+    return occupancy->occupied[x + (occupancy->dim_x*y)];
+}
+
+int search_occupancy_known(const search_occupancy_t *occupancy, int x,
+        int y)
+{
+    if ((x < 0) || (y < 0) || (x >= occupancy->dim_x) ||
+            (y >= occupancy->dim_y)) {
+        return 0;
+    }
+    return occupancy->odds[x + (occupancy->dim_x*y)] != 0;
+}
+
+int search_occupancy_decay(search_occupancy_t *occupancy, int shift)
+{
+    const int cells = occupancy->dim_x*occupancy->dim_y;
+    int changed = 0;
+    for (int c = 0; c < cells; ++c) {
+
+        // Round the step up, so small odds still reach unknown.
+        const int odds = occupancy->odds[c];
+        const int step = ((odds < 0 ? -odds : odds) + (1 << shift) - 1) >> shift;
+        changed += set(occupancy, c,
+                (odds < 0) ? (odds + step) : (odds - step));
+    }
+    return changed;
+}
+
+void search_occupancy_free(search_occupancy_t *occupancy)
+{
+    free(occupancy->odds);
+    free(occupancy->occupied);
+    occupancy->odds = 0;
+    occupancy->occupied = 0;
+}
@@ -0,0 +1,74 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_occupancy_h_
+#define _search_occupancy_h_
+
+// A probabilistic occupancy grid. Rather than a cell being blocked for good
+// the first time the robot bumps into it, each cell keeps the log-odds that
+// it's occupied, and every reading adds its evidence: a bump or a wall
+// reading counts for, driving through a cell or passing it with the wall
+// sensor quiet counts against. Log-odds add, so an update is a saturating
+// add of a signed byte.
+//
+// Planners see a threshold view: a cell turns occupied once its odds reach
+// occupied_odds, and turns free again once they fall below free_odds. The gap
+// between the two keeps a cell near the threshold from flickering. A
+// transient bump is undone by later evidence, or by decaying the odds
+// between runs.
+//
+// Odds are in fixed point, 1/32 nat per unit, so the +/-127 range spans
+// probabilities of about 2% to 98%. A cell with zero odds has no evidence
+// either way, and counts as unknown.
+
+// Hear of a cell whose knowledge or threshold view changed, for instance to
+// keep an exploration frontier up to date.
+typedef void (*search_occupancy_watch_t)(void *context, int x, int y);
+
+typedef struct {
+    int dim_x, dim_y;
+
+    // each cell's log-odds, row-major.
+    signed char *odds;
+
+    // the threshold view, whether each cell counts as occupied.
+    unsigned char *occupied;
+    int occupied_odds, free_odds;
+
+    // told of every cell that turns known or unknown, or whose threshold
+    // view changes, by an update or decay; null for none.
+    search_occupancy_watch_t watch;
+    void *watch_context;
+} search_occupancy_t;
+
+// Allocate an occupancy grid, with every cell unknown (zero odds) and free.
+// free_odds must not exceed occupied_odds.
+// Returns zero on success, non-zero on failure.
+int search_occupancy_alloc(search_occupancy_t *occupancy, int dim_x,
+        int dim_y, int occupied_odds, int free_odds);
+
+// Forget all evidence. The watcher isn't told.
+void search_occupancy_clear(search_occupancy_t *occupancy);
+
+// Add evidence to x,y: positive for occupied, negative for free. Cells off
+// the grid are ignored.
+// Returns non-zero if the cell's threshold view changed.
+int search_occupancy_update(search_occupancy_t *occupancy, int x, int y,
+        int odds);
+
+// Return non-zero if x,y counts as occupied. Cells off the grid don't.
+int search_occupancy_occupied(const search_occupancy_t *occupancy, int x,
+        int y);
+
+// Return non-zero if there's any evidence about x,y. Cells off the grid
+// aren't known.
+int search_occupancy_known(const search_occupancy_t *occupancy, int x,
+        int y);
+
+// Pull every cell's odds toward unknown, by 1/2^shift of the way, so old
+// evidence counts for less than new.
+// Returns the number of cells whose threshold view changed.
+int search_occupancy_decay(search_occupancy_t *occupancy, int shift);
+
+// Free any dynamic memory associated with the grid.
+void search_occupancy_free(search_occupancy_t *occupancy);
+#endif
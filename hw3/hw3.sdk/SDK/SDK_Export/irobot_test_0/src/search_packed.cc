@@ -0,0 +1,252 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+#include "search_packed.h"
+}
+#include "search_heap.h"
+
+// The moves, indexed by the direction_t encoding used in irobot.h.
+static const int moves[][2] = {
+    {-1,0}, // left
+    {0,1},  // forward
+    {1,0},  // right
+    {0,-1}, // back
+};
+
+// The search_bits_neighbors bit for each move.
+static const int move_bits[] = { 1<<0, 1<<3, 1<<1, 1<<2 };
+
+static const uint16_t g_unreached = 0xffff;
+
+// Parent direction helpers, four 2-bit codes per byte.
+static int parent_get(const uint8_t *parent, int i)
+{
+    return (parent[i>>2] >> (2*(i&3))) & 3;
+}
+
+static void parent_set(uint8_t *parent, int i, int d)
+{
+    const int shift = 2*(i&3);
+    parent[i>>2] = (parent[i>>2] & ~(3 << shift)) | (d << shift);
+}
+
+namespace {
+
+// The open list's order, for search_heap.h. Entries don't track their
+// position: a cell reached again by a shorter path gets a new entry, and the
+// stale one is skipped when popped.
+struct packed_heap_ops {
+    bool less(const search_packed_entry_t &a,
+            const search_packed_entry_t &b) const
+    {
+        if (a.f != b.f) {
+            return a.f < b.f;
+        }
+        return a.h < b.h;
+    }
+
+    void place(const search_packed_entry_t &, int) const
+    {
+    }
+};
+
+}
+
+// Place an entry on the open list, growing it if needed.
+// Returns zero on success, non-zero on failure.
+static int heap_push(search_packed_t *map, const search_packed_entry_t &e)
+{
+    if (map->heap_count == map->heap_size) {
+        const int size = 2*map->heap_size;
+        search_packed_entry_t *heap = (search_packed_entry_t*)realloc(
+                map->heap, sizeof(search_packed_entry_t)*size);
+        if (!heap) {
+            std::cout << "realloc failed" << std::endl;
+            return 1;
+        }
+        map->heap = heap;
+        map->heap_size = size;
+    }
+    search_heap_push(map->heap, &map->heap_count, e, packed_heap_ops());
+    return 0;
+}
+
+// The bytes a bitboard of the given dimensions takes.
+static size_t bits_bytes(int dim_x, int dim_y)
+{
+    return sizeof(uint64_t)*((dim_x+63)/64)*dim_y;
+}
+
+size_t search_packed_bytes(int dim_x, int dim_y)
+{
+    const size_t cells = (size_t)dim_x*dim_y;
+    return (sizeof(uint16_t)*cells)
+        + (3*bits_bytes(dim_x, dim_y))
+        + ((cells+3)/4);
+}
+
+int search_packed_alloc(search_packed_t *map, int dim_x, int dim_y)
+{
+    const int cells = dim_x*dim_y;
+    memset(map, 0, sizeof(*map));
+    if (search_bits_alloc(&map->open, dim_x, dim_y) ||
+            search_bits_alloc(&map->closed, dim_x, dim_y) ||
+            search_bits_alloc(&map->blocked, dim_x, dim_y)) {
+        search_packed_free(map);
+        return 1;
+    }
+
+    // A search's frontier is usually a band a few cells deep around the
+    // explored region, so start with room for a few times the perimeter.
+    map->heap_size = 4*(dim_x+dim_y);
+    map->g = (uint16_t*)malloc(sizeof(uint16_t)*cells);
+    map->parent = (uint8_t*)malloc((cells+3)/4);
+    map->heap = (search_packed_entry_t*)malloc(
+            sizeof(search_packed_entry_t)*map->heap_size);
+    if (!map->g || !map->parent || !map->heap) {
+        std::cout << "malloc failed" << std::endl;
+        search_packed_free(map);
+        return 1;
+    }
+    map->dim_x = dim_x;
+    map->dim_y = dim_y;
+    search_packed_initialize(map, 1);
+    return 0;
+}
+
+void search_packed_free(search_packed_t *map)
+{
+    free(map->g);
+    search_bits_free(&map->open);
+    search_bits_free(&map->closed);
+    search_bits_free(&map->blocked);
+    free(map->parent);
+    free(map->heap);
+    memset(map, 0, sizeof(*map));
+}
+
+void search_packed_initialize(search_packed_t *map, int clear_blocked)
+{
+    const int cells = map->dim_x*map->dim_y;
+    memset(map->g, 0xff, sizeof(uint16_t)*cells);
+    search_bits_clear(&map->open);
+    search_bits_clear(&map->closed);
+    if (clear_blocked) {
+        search_bits_clear(&map->blocked);
+    }
+    map->heap_count = 0;
+}
+
+void search_packed_set_blocked(search_packed_t *map, int x, int y, int blocked)
+{
+    search_bits_set(&map->blocked, x, y, blocked);
+}
+
+int search_packed_blocked(const search_packed_t *map, int x, int y)
+{
+    return search_bits_test(&map->blocked, x, y);
+}
+
+int search_packed_find(search_packed_t *map, int start_x, int start_y,
+        int goal_x, int goal_y)
+{
+    const int dim_x = map->dim_x;
+    const int goal = goal_x + (dim_x*goal_y);
+
+    // put the starting point on the open list.
+    map->heap_count = 0;
+    const int start = start_x + (dim_x*start_y);
+    const uint32_t start_h = std::abs(start_x-goal_x) + std::abs(start_y-goal_y);
+    const search_packed_entry_t e = { start_h, start_h, (uint32_t)start };
+    map->g[start] = 0;
+    search_bits_set(&map->open, start_x, start_y, 1);
+    if (heap_push(map, e)) {
+        return -1;
+    }
+
+    // While there are still nodes to process ...
+    while (map->heap_count && !search_bits_test(&map->closed, goal_x, goal_y)) {
+
+        // Process the next open, skipping entries superseded by a shorter
+        // path to a cell that's since been closed.
+        const search_packed_entry_t current = search_heap_pop(map->heap,
+                &map->heap_count, packed_heap_ops());
+        const int i = current.index;
+        const int x = i % dim_x;
+        const int y = i / dim_x;
+        if (!search_bits_test(&map->open, x, y)) {
+            continue;
+        }
+        search_bits_set(&map->open, x, y, 0);
+        search_bits_set(&map->closed, x, y, 1);
+
+        const int g = map->g[i] + 1;
+        if (g > search_packed_g_max) {
+            continue;
+        }
+
+        // Check all adjacent cells.
+        // Ignore cells that are closed, unpassable or off the map.
+        const int skip = search_bits_neighbors(&map->blocked, x, y)
+            | search_bits_neighbors(&map->closed, x, y);
+        for (int d = 0; d < 4; ++d) {
+            if (skip & move_bits[d]) {
+                continue;
+            }
+            const int ax = x + moves[d][0];
+            const int ay = y + moves[d][1];
+
+            // Only a shorter path earns a new open list entry.
+            const int adj = ax + (dim_x*ay);
+            if (g >= map->g[adj]) {
+                continue;
+            }
+            map->g[adj] = g;
+            parent_set(map->parent, adj, d);
+            search_bits_set(&map->open, ax, ay, 1);
+            const uint32_t h = std::abs(ax-goal_x) + std::abs(ay-goal_y);
+            const search_packed_entry_t e = { g+h, h, (uint32_t)adj };
+            if (heap_push(map, e)) {
+                return -1;
+            }
+        }
+    }
+
+    if (!search_bits_test(&map->closed, goal_x, goal_y)) {
+        return -1;
+    }
+    return map->g[goal];
+}
+
+int search_packed_path(const search_packed_t *map, int goal_x, int goal_y,
+        int *coords, int count)
+{
+    int i = goal_x + (map->dim_x*goal_y);
+    if (map->g[i] == g_unreached) {
+        return 0;
+    }
+
+    // Walk back from the goal. The g of each cell is its position on the path.
+    const int length = map->g[i] + 1;
+    int x = goal_x;
+    int y = goal_y;
+    for (;;) {
+        const int k = map->g[i];
+        if (k < count) {
+            coords[2*k] = x;
+            coords[(2*k)+1] = y;
+        }
+        if (!k) {
+            break;
+        }
+        const int d = parent_get(map->parent, i);
+        x -= moves[d][0];
+        y -= moves[d][1];
+        i = x + (map->dim_x*y);
+    }
+    return length;
+}
@@ -0,0 +1,76 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_packed_h_
+#define _search_packed_h_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "search_bits.h"
+
+// A structure-of-arrays alternative to search_map_t, for arenas too large to
+// hold a search_cell_t per cell. Per cell this stores a 16-bit g, one bit in
+// each of the open, closed and blocked bitboards, and a 2-bit code for the
+// direction the cell was entered from. That's under 3 bytes a cell, where a
+// search_cell_t is well over 40. The open list only holds the frontier.
+//
+// Cells are addressed by x,y. Paths longer than search_packed_g_max steps
+// can't be represented and are reported as not found.
+#define search_packed_g_max 0xfffe
+
+// An open list entry. The open list may hold stale entries for cells that
+// were later reached by a shorter path; they're skipped when popped.
+typedef struct {
+    uint32_t f;
+    uint32_t h;
+    uint32_t index;
+} search_packed_entry_t;
+
+typedef struct {
+    int dim_x, dim_y;
+
+    // cost from the start, 0xffff if unreached.
+    uint16_t *g;
+
+    // bitboards, one bit per cell.
+    search_bits_t open, closed, blocked;
+
+    // the direction_t the cell was entered from, four cells per byte.
+    uint8_t *parent;
+
+    // the open list, a binary min-heap ordered by (f,h). This starts with
+    // room for a frontier across the map, grows to the largest frontier seen
+    // and is reused between searches.
+    search_packed_entry_t *heap;
+    int heap_count, heap_size;
+} search_packed_t;
+
+// Allocate a packed map with all cells unblocked.
+// Returns zero on success, non-zero on failure.
+int search_packed_alloc(search_packed_t *map, int dim_x, int dim_y);
+
+// The number of bytes allocated per map, not counting the open list.
+size_t search_packed_bytes(int dim_x, int dim_y);
+
+// Reset the search state of the map. If clear blocked is set, all cells are
+// also unblocked.
+void search_packed_initialize(search_packed_t *map, int clear_blocked);
+
+// Set or test the blocked state of a cell.
+void search_packed_set_blocked(search_packed_t *map, int x, int y, int blocked);
+int search_packed_blocked(const search_packed_t *map, int x, int y);
+
+// Find the goal from the start. The map must be initialized with
+// search_packed_initialize before calling this function.
+// Returns the path length in steps, or -1 if the goal can't be reached.
+int search_packed_find(search_packed_t *map, int start_x, int start_y,
+        int goal_x, int goal_y);
+
+// Write the path found by search_packed_find into coords as x,y pairs from
+// start to goal. At most count pairs are written.
+// Returns the number of cells on the path, which may exceed count.
+int search_packed_path(const search_packed_t *map, int goal_x, int goal_y,
+        int *coords, int count);
+
+// Free any dynamic memory associated with the map.
+void search_packed_free(search_packed_t *map);
+#endif
@@ -0,0 +1,124 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+#include "search_path.h"
+}
+
+// The cell delta of each move.
+static const int moves[][2] = {{-1,0},{0,1},{1,0},{0,-1}};
+
+int search_path_alloc(search_path_t *path, int capacity)
+{
+    path->moves = (unsigned char*)malloc(search_path_bytes(capacity));
+    if (!path->moves) {
+        std::cout << "malloc failed" << std::endl;
+        path->capacity = 0;
+        search_path_clear(path, 0, 0);
+        return 1;
+    }
+    path->capacity = capacity;
+    search_path_clear(path, 0, 0);
+    return 0;
+}
+
+void search_path_free(search_path_t *path)
+{
+    free(path->moves);
+    path->moves = 0;
+    path->capacity = 0;
+    path->length = 0;
+}
+
+void search_path_clear(search_path_t *path, int x, int y)
+{
+    path->start_x = x;
+    path->start_y = y;
+    path->length = 0;
+}
+
+int search_path_push(search_path_t *path, int move)
+{
+    if (path->length >= path->capacity) {
+        return 1;
+    }
+    search_path_set(path, path->length++, move);
+    return 0;
+}
+
+int search_path_move(const search_path_t *path, int i)
+{
+    return (path->moves[i>>2] >> ((i&3)*2)) & 3;
+}
+
+void search_path_set(search_path_t *path, int i, int move)
+{
+    const int shift = (i&3)*2;
+    path->moves[i>>2] = (unsigned char)
+        ((path->moves[i>>2] & ~(3 << shift)) | ((move&3) << shift));
+}
+
+void search_path_step(int move, int *x, int *y)
+{
+    *x += moves[move][0];
+    *y += moves[move][1];
+}
+
+int search_path_direction(int dx, int dy)
+{
+    if (dx) {
+        return (dx < 0) ? 0 : 2;
+    }
+    return (dy < 0) ? 3 : 1;
+}
+
+int search_path_run(const search_path_t *path, int i, int max)
+{
+    const int move = search_path_move(path, i);
+    int end = i+1;
+    while ((end < path->length) && (!max || ((end-i) < max)) &&
+            (search_path_move(path, end) == move)) {
+        ++end;
+    }
+    return end - i;
+}
+
+int search_path_equal(const search_path_t *a, const search_path_t *b)
+{
+    if ((a->start_x != b->start_x) || (a->start_y != b->start_y) ||
+            (a->length != b->length)) {
+        return 0;
+    }
+
+    // Compare whole bytes, then the moves in the last partial byte.
+    const int whole = a->length/4;
+    if (memcmp(a->moves, b->moves, whole)) {
+        return 0;
+    }
+    for (int i = whole*4; i < a->length; ++i) {
+        if (search_path_move(a, i) != search_path_move(b, i)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int search_path_copy(search_path_t *path, const search_cell_t *start)
+{
+    search_path_clear(path, start->x, start->y);
+    for (const search_cell_t *c = start; c->next; c = c->next) {
+        const int dx = c->next->x - c->x;
+        const int dy = c->next->y - c->y;
+
+        if ((std::abs(dx) + std::abs(dy)) != 1) {
+            return 1;
+        }
+        if (search_path_push(path, search_path_direction(dx, dy))) {
+            return 1;
+        }
+    }
+    return 0;
+}
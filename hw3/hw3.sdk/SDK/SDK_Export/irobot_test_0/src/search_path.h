@@ -0,0 +1,75 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_path_h_
+#define _search_path_h_
+
+#include "search.h"
+
+// A path held apart from the map: the cell it starts from, then one move per
+// step, packed four to a byte. Unlike a path threaded through the cells'
+// prev and next fields, it survives the map being searched again, so it can
+// be kept, compared with another path, or sent over a link as it is.
+//
+// Moves use the direction_t encoding: 0 is -x, 1 is +y, 2 is +x, 3 is -y.
+typedef struct {
+    // the cell the path starts from.
+    int start_x, start_y;
+
+    // the number of moves, and the most the buffer holds.
+    int length, capacity;
+
+    // the moves, the first in the low two bits of moves[0].
+    unsigned char *moves;
+} search_path_t;
+
+// The bytes needed to hold count moves.
+#define search_path_bytes(count) (((count)+3)/4)
+
+// Allocate room for capacity moves from the heap. A path through a map never
+// needs more moves than the map has cells.
+// Returns zero on success, non-zero on failure.
+int search_path_alloc(search_path_t *path, int capacity);
+
+// Empty the path, starting it from x,y.
+void search_path_clear(search_path_t *path, int x, int y);
+
+// Append a move.
+// Returns zero on success, non-zero if the path is full.
+int search_path_push(search_path_t *path, int move);
+
+// Return move i of the path.
+int search_path_move(const search_path_t *path, int i);
+
+// Replace move i of the path, which must be below its length.
+void search_path_set(search_path_t *path, int i, int move);
+
+// Step x,y by a move.
+void search_path_step(int move, int *x, int *y);
+
+// Return the move to the neighbor dx,dy away.
+int search_path_direction(int dx, int dy);
+
+// Return how many moves from move i on repeat move i, at most max, or all of
+// them if max is zero. Each run is one straight drive.
+int search_path_run(const search_path_t *path, int i, int max);
+
+// Return non-zero if both paths make the same moves from the same cell.
+int search_path_equal(const search_path_t *a, const search_path_t *b);
+
+// Copy the path threaded through the cells' next fields from start, as every
+// planner leaves it.
+// Returns zero on success, non-zero if the path doesn't fit or a step isn't
+// to a neighbor.
+int search_path_copy(search_path_t *path, const search_cell_t *start);
+
+// Like search_find_mode, but the path is written to path rather than threaded
+// through the cells' next fields. The map must be initialized with
+// search_map_initialize first.
+// Returns zero on success, non-zero if the goal can't be reached or the path
+// doesn't fit.
+int search_find_path(search_map_t *map, search_cell_t *start,
+        search_cell_t *goal, search_mode_t mode, search_path_t *path);
+
+// Free any dynamic memory associated with the path.
+void search_path_free(search_path_t *path);
+#endif
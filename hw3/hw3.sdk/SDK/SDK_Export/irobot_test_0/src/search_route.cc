@@ -0,0 +1,256 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#include <iostream>
+#include <cstdlib>
+#include <limits>
+
+extern "C" {
+#include "search_route.h"
+}
+
+static const int infinity = std::numeric_limits<int>::max()/4;
+
+// The path cost matrix between stops. Stop 0 is the base, and stop i+1 is
+// waypoint i.
+typedef struct {
+    int stops;
+    int *cost;
+} route_t;
+
+static int leg(const route_t *route, int a, int b)
+{
+    return route->cost[(route->stops*a)+b];
+}
+
+// Fill the cost matrix with one distance field per stop.
+static void route_costs(route_t *route, search_map_t *map,
+        search_field_t *field, const int *stops)
+{
+    for (int a = 0; a < route->stops; ++a) {
+        search_distance_field(field, map, stops[2*a], stops[(2*a)+1]);
+        for (int b = 0; b < route->stops; ++b) {
+            route->cost[(route->stops*a)+b] =
+                search_field_distance(field, stops[2*b], stops[(2*b)+1]);
+        }
+    }
+}
+
+// Order the waypoints exactly with the Held-Karp dynamic program. best[m][j]
+// is the shortest path from the base through the waypoints in mask m that
+// ends at waypoint j.
+static int route_exact(const route_t *route, int *order, int *length)
+{
+    const int n = route->stops-1;
+    const int full = 1 << n;
+    int *best = (int*)malloc(sizeof(int)*full*n);
+    unsigned char *parent = (unsigned char*)malloc(full*n);
+    if (!best || !parent) {
+        std::cout << "malloc failed" << std::endl;
+        free(best);
+        free(parent);
+        return 1;
+    }
+    for (int i = 0; i < full*n; ++i) {
+        best[i] = infinity;
+    }
+    for (int j = 0; j < n; ++j) {
+        best[((1<<j)*n)+j] = leg(route, 0, j+1);
+    }
+    for (int m = 1; m < full; ++m) {
+        for (int j = 0; j < n; ++j) {
+            const int v = best[(m*n)+j];
+            if (!(m & (1<<j)) || (v >= infinity)) {
+                continue;
+            }
+            for (int k = 0; k < n; ++k) {
+                if (m & (1<<k)) {
+                    continue;
+                }
+                const int i = ((m|(1<<k))*n)+k;
+                const int c = v + leg(route, j+1, k+1);
+                if (c < best[i]) {
+                    best[i] = c;
+                    parent[i] = j;
+                }
+            }
+        }
+    }
+
+    // Close the tour, then walk the parents back from the best last stop.
+    int j = 0;
+    int total = infinity;
+    for (int k = 0; k < n; ++k) {
+        const int c = best[((full-1)*n)+k] + leg(route, k+1, 0);
+        if (c < total) {
+            total = c;
+            j = k;
+        }
+    }
+    int m = full-1;
+    for (int i = n-1; i >= 0; --i) {
+        order[i] = j;
+        const int p = parent[(m*n)+j];
+        m &= ~(1<<j);
+        j = p;
+    }
+    *length = total;
+    free(best);
+    free(parent);
+    return 0;
+}
+
+// The stop at position i of a closed tour of n+1 stops.
+static int tour_at(const int *tour, int n, int i)
+{
+    return (i > n) ? tour[0] : tour[i];
+}
+
+static int tour_length(const route_t *route, const int *tour, int n)
+{
+    int total = 0;
+    for (int i = 0; i <= n; ++i) {
+        total += leg(route, tour[i], tour_at(tour, n, i+1));
+    }
+    return total;
+}
+
+// Reverse the tour between positions i and k when that shortens it. Paths
+// on the grid cost the same both ways, so only the two end edges change.
+static int improve_2opt(const route_t *route, int *tour, int n)
+{
+    for (int i = 1; i < n; ++i) {
+        for (int k = i+1; k <= n; ++k) {
+            const int a = tour[i-1], b = tour[i];
+            const int c = tour[k], d = tour_at(tour, n, k+1);
+            if ((leg(route,a,c) + leg(route,b,d)) <
+                    (leg(route,a,b) + leg(route,c,d))) {
+                for (int lo = i, hi = k; lo < hi; ++lo, --hi) {
+                    const int t = tour[lo];
+                    tour[lo] = tour[hi];
+                    tour[hi] = t;
+                }
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Move a run of up to three stops between two other stops when that
+// shortens the tour.
+static int improve_oropt(const route_t *route, int *tour, int n)
+{
+    for (int len = 1; len <= 3; ++len) {
+        for (int i = 1; (i+len-1) <= n; ++i) {
+            const int first = tour[i], last = tour[i+len-1];
+            const int prev = tour[i-1], next = tour_at(tour, n, i+len);
+            const int gain = leg(route,prev,first) + leg(route,last,next)
+                - leg(route,prev,next);
+
+            // Insert between positions j and j+1, outside the run.
+            for (int j = 0; j <= n; ++j) {
+                if ((j >= (i-1)) && (j < (i+len))) {
+                    continue;
+                }
+                const int a = tour[j], b = tour_at(tour, n, j+1);
+                const int cost = leg(route,a,first) + leg(route,last,b)
+                    - leg(route,a,b);
+                if (cost >= gain) {
+                    continue;
+                }
+                int run[3];
+                for (int r = 0; r < len; ++r) {
+                    run[r] = tour[i+r];
+                }
+                if (j < i) {
+                    for (int p = i-1; p > j; --p) {
+                        tour[p+len] = tour[p];
+                    }
+                    for (int r = 0; r < len; ++r) {
+                        tour[j+1+r] = run[r];
+                    }
+                } else {
+                    for (int p = i+len; p <= j; ++p) {
+                        tour[p-len] = tour[p];
+                    }
+                    for (int r = 0; r < len; ++r) {
+                        tour[j-len+1+r] = run[r];
+                    }
+                }
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Order the waypoints by nearest neighbor, then improve with 2-opt and
+// Or-opt until neither finds a shorter tour.
+static int route_heuristic(const route_t *route, int *order, int *length)
+{
+    const int n = route->stops-1;
+    int *tour = (int*)malloc(sizeof(int)*(n+1));
+    if (!tour) {
+        std::cout << "malloc failed" << std::endl;
+        return 1;
+    }
+    for (int i = 0; i <= n; ++i) {
+        tour[i] = i;
+    }
+    for (int i = 1; i < n; ++i) {
+        int nearest = i;
+        for (int k = i+1; k <= n; ++k) {
+            if (leg(route,tour[i-1],tour[k]) < leg(route,tour[i-1],tour[nearest])) {
+                nearest = k;
+            }
+        }
+        const int t = tour[i];
+        tour[i] = tour[nearest];
+        tour[nearest] = t;
+    }
+    while (improve_2opt(route, tour, n) || improve_oropt(route, tour, n)) {
+    }
+    for (int i = 0; i < n; ++i) {
+        order[i] = tour[i+1]-1;
+    }
+    *length = tour_length(route, tour, n);
+    free(tour);
+    return 0;
+}
+
+int search_route_order(search_map_t *map, search_field_t *field, int base_x,
+        int base_y, const int *waypoints, int count, int *order, int *length)
+{
+    int total = 0;
+    if (!length) {
+        length = &total;
+    }
+    *length = 0;
+    if (count <= 0) {
+        return 0;
+    }
+
+    route_t route;
+    route.stops = count+1;
+    route.cost = (int*)malloc(sizeof(int)*route.stops*route.stops);
+    int *stops = (int*)malloc(sizeof(int)*2*route.stops);
+    if (!route.cost || !stops) {
+        std::cout << "malloc failed" << std::endl;
+        free(route.cost);
+        free(stops);
+        return 1;
+    }
+    stops[0] = base_x;
+    stops[1] = base_y;
+    for (int i = 0; i < 2*count; ++i) {
+        stops[i+2] = waypoints[i];
+    }
+    route_costs(&route, map, field, stops);
+    free(stops);
+
+    const int status = (count <= search_route_exact_max)
+        ? route_exact(&route, order, length)
+        : route_heuristic(&route, order, length);
+    free(route.cost);
+    return status;
+}
@@ -0,0 +1,24 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_route_h_
+#define _search_route_h_
+
+#include "search.h"
+#include "search_field.h"
+
+// Routes with at most this many waypoints are ordered exactly (Held-Karp).
+// Longer routes start from nearest neighbor and are improved with 2-opt and
+// Or-opt moves until neither helps.
+#define search_route_exact_max 12
+
+// Order waypoints so the tour from base through every waypoint and back to
+// base is as short as possible. Waypoints are cell coordinates, x,y pairs.
+// The path cost between every pair of stops comes from one distance field
+// per stop, so obstacles on the map are accounted for. On success order
+// holds the waypoint indices in visiting order and length, if not null, the
+// length of the tour in cells; an unreachable leg counts as
+// search_field_unreached.
+// Returns zero on success, non-zero on failure.
+int search_route_order(search_map_t *map, search_field_t *field, int base_x,
+        int base_y, const int *waypoints, int count, int *order, int *length);
+#endif
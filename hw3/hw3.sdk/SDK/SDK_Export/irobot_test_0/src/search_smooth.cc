@@ -0,0 +1,89 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#include <cstdlib>
+
+extern "C" {
+#include "search_smooth.h"
+}
+
+int search_line_of_sight(const search_bits_t *bits, int x0, int y0, int x1,
+        int y1)
+{
+    // Walk the cells the line crosses, stepping in x or y depending on which
+    // cell boundary the line meets first. The error term is kept doubled so
+    // it stays integral.
+    const int dx = std::abs(x1-x0), dy = std::abs(y1-y0);
+    const int sx = (x1 < x0) ? -1 : 1, sy = (y1 < y0) ? -1 : 1;
+    int x = x0, y = y0;
+    int error = dx - dy;
+    for (int n = dx + dy; ; --n) {
+        if (search_bits_test(bits, x, y)) {
+            return 0;
+        }
+        if (n <= 0) {
+            break;
+        }
+        if (error > 0) {
+            x += sx;
+            error -= 2*dy;
+        } else if (error < 0) {
+            y += sy;
+            error += 2*dx;
+        } else {
+
+            // The line passes exactly through a corner, squeezing between the
+            // two cells beside it; both must be free.
+            if (search_bits_test(bits, x+sx, y) ||
+                    search_bits_test(bits, x, y+sy)) {
+                return 0;
+            }
+            x += sx;
+            y += sy;
+            error += 2*(dx - dy);
+            --n;
+        }
+    }
+    return 1;
+}
+
+int search_path_smooth(const search_bits_t *bits, const search_path_t *path,
+        int *waypoints, int capacity)
+{
+    if (capacity < 1) {
+        return -1;
+    }
+    int count = 0;
+    int anchor_x = path->start_x, anchor_y = path->start_y;
+    waypoints[2*count] = anchor_x;
+    waypoints[(2*count)+1] = anchor_y;
+    ++count;
+
+    // Follow the path, keeping the cell before the first one the last
+    // waypoint can't see.
+    int prev_x = anchor_x, prev_y = anchor_y;
+    int x = anchor_x, y = anchor_y;
+    for (int i = 0; i < path->length; ++i) {
+        search_path_step(search_path_move(path, i), &x, &y);
+        if (!search_line_of_sight(bits, anchor_x, anchor_y, x, y)) {
+            if (count >= capacity) {
+                return -1;
+            }
+            anchor_x = prev_x;
+            anchor_y = prev_y;
+            waypoints[2*count] = anchor_x;
+            waypoints[(2*count)+1] = anchor_y;
+            ++count;
+        }
+        prev_x = x;
+        prev_y = y;
+    }
+    if ((anchor_x != x) || (anchor_y != y)) {
+        if (count >= capacity) {
+            return -1;
+        }
+        waypoints[2*count] = x;
+        waypoints[(2*count)+1] = y;
+        ++count;
+    }
+    return count;
+}
@@ -0,0 +1,32 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_smooth_h_
+#define _search_smooth_h_
+
+#include "search_bits.h"
+#include "search_path.h"
+
+// Any-angle smoothing for grid paths. A path from any of the planners only
+// moves between neighbors, so it zigzags across open ground and each turn
+// costs the robot a stop and a rotation. Smoothing keeps only the cells the
+// path must pass through, and joins them with straight lines that clear every
+// obstacle, just as Theta* chooses parents by line of sight while it
+// searches.
+//
+// Lines are tested against cell centers on the occupancy bitboard. The robot
+// is taken to be a point, so inflate obstacles by its footprint first, with
+// search_cspace.
+
+// Return non-zero if the straight line between the centers of x0,y0 and x1,y1
+// crosses no blocked cell. Every cell the line touches counts, including both
+// cells beside a corner it passes exactly through.
+int search_line_of_sight(const search_bits_t *bits, int x0, int y0, int x1,
+        int y1);
+
+// Pull the path taut. From the path's start, each waypoint is the last cell
+// of the path in line of sight of the waypoint before it. Waypoints are
+// written as x,y pairs, the first the path's start and the last its end.
+// Returns the number of waypoints, or -1 if they don't fit in capacity pairs.
+int search_path_smooth(const search_bits_t *bits, const search_path_t *path,
+        int *waypoints, int capacity);
+#endif
@@ -0,0 +1,112 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#include <cstring>
+
+extern "C" {
+#include "search_snapshot.h"
+}
+
+static const char magic[4] = {'S','M','A','P'};
+
+// The header is padded so the rows that follow it stay 8 byte aligned.
+static const size_t header_bytes = (sizeof(search_snapshot_header_t)+7) & ~(size_t)7;
+
+static uint32_t fnv1a(uint32_t hash, const void *data, size_t size)
+{
+    const unsigned char *p = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ p[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Hash the header, less its checksum, and then the rows.
+static uint32_t checksum(search_snapshot_header_t header, const uint64_t *rows)
+{
+    header.checksum = 0;
+    const uint32_t hash = fnv1a(2166136261u, &header, sizeof(header));
+    return fnv1a(hash, rows,
+            sizeof(uint64_t)*(size_t)header.words*header.dim_y);
+}
+
+size_t search_snapshot_bytes(int dim_x, int dim_y)
+{
+    return header_bytes + (sizeof(uint64_t)*((dim_x+63)/64)*dim_y);
+}
+
+int search_snapshot_write(const search_bits_t *bits, unsigned runs,
+        void *buffer, size_t size)
+{
+    if (size < search_snapshot_bytes(bits->dim_x, bits->dim_y)) {
+        return 1;
+    }
+    const size_t words = (size_t)bits->words*bits->dim_y;
+    search_snapshot_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, magic, sizeof(magic));
+    header.version = search_snapshot_version;
+    header.header_bytes = (uint16_t)header_bytes;
+    header.byte_order = search_snapshot_byte_order;
+    header.dim_x = bits->dim_x;
+    header.dim_y = bits->dim_y;
+    header.words = bits->words;
+    header.runs = runs;
+    header.checksum = checksum(header, bits->rows);
+
+    unsigned char *b = (unsigned char*)buffer;
+    memset(b, 0, header_bytes);
+    memcpy(b, &header, sizeof(header));
+    memcpy(b + header_bytes, bits->rows, sizeof(uint64_t)*words);
+    return 0;
+}
+
+int search_snapshot_view(const void *buffer, size_t size,
+        search_bits_t *bits, unsigned *runs)
+{
+    search_snapshot_header_t header;
+    if (size < header_bytes) {
+        return 1;
+    }
+    memcpy(&header, buffer, sizeof(header));
+    if (memcmp(header.magic, magic, sizeof(magic)) ||
+            (header.version != search_snapshot_version) ||
+            (header.header_bytes != header_bytes) ||
+            (header.byte_order != search_snapshot_byte_order)) {
+        return 1;
+    }
+    if ((header.dim_x <= 0) || (header.dim_y <= 0) ||
+            (header.dim_x > (1<<15)) || (header.dim_y > (1<<15)) ||
+            (header.words != ((header.dim_x+63)/64)) ||
+            (size < search_snapshot_bytes(header.dim_x, header.dim_y))) {
+        return 1;
+    }
+    if ((uintptr_t)buffer & 7) {
+        return 1;
+    }
+
+    const uint64_t *rows = (const uint64_t*)((const unsigned char*)buffer +
+            header_bytes);
+    if (checksum(header, rows) != header.checksum) {
+        return 1;
+    }
+
+    // Scans rely on the bits past dim_x being set.
+    const int used = header.dim_x & 63;
+    if (used) {
+        const uint64_t padding = ~(uint64_t)0 << used;
+        for (int y = 0; y < header.dim_y; ++y) {
+            if ((rows[(header.words*(y+1))-1] & padding) != padding) {
+                return 1;
+            }
+        }
+    }
+
+    bits->dim_x = header.dim_x;
+    bits->dim_y = header.dim_y;
+    bits->words = header.words;
+    bits->rows = (uint64_t*)rows;
+    if (runs) {
+        *runs = header.runs;
+    }
+    return 0;
+}
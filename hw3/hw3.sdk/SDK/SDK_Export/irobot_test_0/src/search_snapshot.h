@@ -0,0 +1,62 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_snapshot_h_
+#define _search_snapshot_h_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "search_bits.h"
+
+// A snapshot of what's known about an arena's obstacles, so a later run can
+// start from it rather than from an empty map. A snapshot is a header
+// followed by the occupancy bitboard's rows exactly as search_bits keeps them
+// in memory, so a snapshot in a buffer or a mapped file is used in place
+// without copying it.
+//
+// All fields are stored in the writer's byte order, which the header records.
+// A reader with a different byte order rejects the snapshot rather than
+// swapping it.
+typedef struct {
+    // identifies a snapshot, "SMAP".
+    char magic[4];
+
+    // the format version, and the size of this header. The rows start
+    // header_bytes into the snapshot.
+    uint16_t version;
+    uint16_t header_bytes;
+
+    // search_snapshot_byte_order, as the writer stored it.
+    uint32_t byte_order;
+
+    // the bitboard's dimensions, and the 64-bit words per row.
+    int32_t dim_x, dim_y;
+    int32_t words;
+
+    // the number of runs whose obstacles the snapshot holds.
+    uint32_t runs;
+
+    // an FNV-1a hash of this header, taking the checksum as zero, and then
+    // the rows.
+    uint32_t checksum;
+} search_snapshot_header_t;
+
+#define search_snapshot_version 1
+#define search_snapshot_byte_order 0x01020304
+
+// The bytes a snapshot of a dim_x by dim_y bitboard takes.
+size_t search_snapshot_bytes(int dim_x, int dim_y);
+
+// Write a snapshot of the bitboard into the buffer.
+// Returns zero on success, non-zero if the buffer is too small.
+int search_snapshot_write(const search_bits_t *bits, unsigned runs,
+        void *buffer, size_t size);
+
+// Check the snapshot in the buffer and point bits at its rows, which stay in
+// the buffer; bits is only valid while the buffer is, and mustn't be changed
+// if the buffer is read-only. The buffer must be 8 byte aligned, as malloc
+// and mmap leave it. runs may be null.
+// Returns zero on success, non-zero if the snapshot is malformed, from a
+// different version or byte order, or fails its checksum.
+int search_snapshot_view(const void *buffer, size_t size,
+        search_bits_t *bits, unsigned *runs);
+#endif
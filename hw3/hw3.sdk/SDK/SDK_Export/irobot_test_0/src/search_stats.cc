@@ -0,0 +1,144 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include "search_stats.h"
+}
+
+// The histogram bucket for a value.
+static int bucket(uint64_t value)
+{
+    int i = 0;
+    while (value && (i < (search_stats_buckets-1))) {
+        value >>= 1;
+        ++i;
+    }
+    return i;
+}
+
+void search_stats_clear(search_stats_t *stats)
+{
+    const search_stats_clock_t clock = stats->clock;
+    memset(stats, 0, sizeof(*stats));
+    stats->clock = clock;
+}
+
+void search_stats_begin(search_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    memset(&stats->last, 0, sizeof(stats->last));
+    stats->started = stats->clock ? stats->clock() : 0;
+}
+
+void search_stats_push(search_stats_t *stats, int open_count)
+{
+    if (stats) {
+        ++stats->last.pushes;
+        stats->last.open_peak = std::max(stats->last.open_peak, open_count);
+    }
+}
+
+void search_stats_pop(search_stats_t *stats)
+{
+    if (stats) {
+        ++stats->last.pops;
+    }
+}
+
+void search_stats_decrease(search_stats_t *stats)
+{
+    if (stats) {
+        ++stats->last.decreases;
+    }
+}
+
+void search_stats_expand(search_stats_t *stats, int cells)
+{
+    if (stats) {
+        stats->last.expanded += cells;
+    }
+}
+
+void search_stats_end(search_stats_t *stats, int found)
+{
+    if (!stats) {
+        return;
+    }
+    search_stats_query_t *last = &stats->last;
+    search_stats_query_t *max = &stats->max;
+    if (stats->clock) {
+        last->ticks = stats->clock() - stats->started;
+    }
+    ++stats->queries;
+    if (found) {
+        ++stats->found;
+    }
+    stats->expanded += last->expanded;
+    stats->pushes += last->pushes;
+    stats->pops += last->pops;
+    stats->decreases += last->decreases;
+    stats->ticks += last->ticks;
+    max->expanded = std::max(max->expanded, last->expanded);
+    max->pushes = std::max(max->pushes, last->pushes);
+    max->pops = std::max(max->pops, last->pops);
+    max->decreases = std::max(max->decreases, last->decreases);
+    max->open_peak = std::max(max->open_peak, last->open_peak);
+    max->ticks = std::max(max->ticks, last->ticks);
+    ++stats->expanded_histogram[bucket(last->expanded)];
+    ++stats->ticks_histogram[bucket(last->ticks)];
+}
+
+// Print the non-empty buckets of a histogram, scaling bucket bounds down by
+// the given divisor.
+static void print_histogram(const char *name, const int *histogram,
+        unsigned divisor)
+{
+    for (int i = 0; i < search_stats_buckets; ++i) {
+        if (!histogram[i]) {
+            continue;
+        }
+        const uint64_t lo = i ? ((uint64_t)1 << (i-1)) : 0;
+        const uint64_t hi = (uint64_t)1 << i;
+        std::cout << "stats " << name << ' ' << (lo/divisor) << '-';
+        if (i == (search_stats_buckets-1)) {
+            std::cout << "max";
+        } else {
+            std::cout << (hi/divisor);
+        }
+        std::cout << ": " << histogram[i] << std::endl;
+    }
+}
+
+void search_stats_print(const search_stats_t *stats, unsigned ticks_per_us)
+{
+    const int queries = stats->queries;
+    const unsigned divisor = ticks_per_us ? ticks_per_us : 1;
+    std::cout << "stats queries " << queries
+              << " found " << stats->found << std::endl;
+    if (!queries) {
+        return;
+    }
+    std::cout << "stats per query (mean/max):"
+              << " expanded " << (stats->expanded/queries)
+              << '/' << stats->max.expanded
+              << " pushes " << (stats->pushes/queries)
+              << '/' << stats->max.pushes
+              << " pops " << (stats->pops/queries)
+              << '/' << stats->max.pops
+              << " decreases " << (stats->decreases/queries)
+              << '/' << stats->max.decreases
+              << " open peak " << stats->max.open_peak << std::endl;
+    std::cout << "stats time (mean/max/total) "
+              << (stats->ticks/queries/divisor)
+              << '/' << (stats->max.ticks/divisor)
+              << '/' << (stats->ticks/divisor)
+              << (ticks_per_us ? " us" : " ticks") << std::endl;
+    print_histogram("expanded", stats->expanded_histogram, 1);
+    print_histogram(ticks_per_us ? "us" : "ticks", stats->ticks_histogram,
+            divisor);
+}
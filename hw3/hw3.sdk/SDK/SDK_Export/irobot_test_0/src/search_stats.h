@@ -0,0 +1,72 @@
+// Joshua Emele <jemele@acm.org>
+// Tristan Monroe <twmonroe@eng.ucsd.edu>
+#ifndef _search_stats_h_
+#define _search_stats_h_
+
+#include <stdint.h>
+
+// What searches cost. Point a map's stats at one of these and search_find,
+// search_dstar_find, search_lattice_find and search_distance_field count
+// each query's work into last, then fold it into the totals and histograms,
+// so the cost of replans can be read off the console after a run.
+
+// Return the time now in the caller's ticks: XTime counts on the zed, say.
+typedef uint64_t (*search_stats_clock_t)(void);
+
+// The work one query did.
+typedef struct {
+    // cells expanded, and open list operations.
+    int expanded, pushes, pops, decreases;
+
+    // the most cells on the open list at once.
+    int open_peak;
+
+    // time spent, in clock ticks; 0 without a clock.
+    uint64_t ticks;
+} search_stats_query_t;
+
+// Histogram bucket 0 counts zeros, and bucket i counts values in
+// [2^(i-1), 2^i). The last bucket also takes everything larger.
+#define search_stats_buckets 24
+
+typedef struct {
+    // the clock to time queries with, or null to skip timing.
+    search_stats_clock_t clock;
+
+    // the last query, and when it started.
+    search_stats_query_t last;
+    uint64_t started;
+
+    // the queries so far, and how many found their goal.
+    int queries, found;
+
+    // sums and maxima of every field over the queries so far.
+    uint64_t expanded, pushes, pops, decreases, ticks;
+    search_stats_query_t max;
+
+    // the queries so far by cells expanded and by ticks.
+    int expanded_histogram[search_stats_buckets];
+    int ticks_histogram[search_stats_buckets];
+} search_stats_t;
+
+// Forget every query, keeping the clock.
+void search_stats_clear(search_stats_t *stats);
+
+// Start counting a query. Like every call below but clear and print, this
+// does nothing if stats is null, so planners can count unconditionally.
+void search_stats_begin(search_stats_t *stats);
+
+// Count work into the query being counted: a push leaving open_count cells
+// on the open list, a pop, a reordered cell, and cells expanded.
+void search_stats_push(search_stats_t *stats, int open_count);
+void search_stats_pop(search_stats_t *stats);
+void search_stats_decrease(search_stats_t *stats);
+void search_stats_expand(search_stats_t *stats, int cells);
+
+// Finish counting a query, and fold it into the totals.
+void search_stats_end(search_stats_t *stats, int found);
+
+// Print the totals and histograms, converting ticks to microseconds with the
+// given rate (0 prints raw ticks).
+void search_stats_print(const search_stats_t *stats, unsigned ticks_per_us);
+#endif